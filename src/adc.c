@@ -0,0 +1,146 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file adc.c
+ * This file contains the command adc which streams ADC samples to the host.
+ * The binary output starts with the magic "ADC" followed by the channel, the
+ * sample rate in Hz and the number of samples (16 bit little endian each).
+ * Then follow frames of up to ADC_HALF samples (8 bit). Each frame starts
+ * with 'D', the number of samples, and the number of samples lost before the
+ * frame (16 bit). Finally a line "= <lost samples>" is output. tools/adc2csv.py
+ * converts the output into a CSV file.
+ *
+ * @author Bernhard R. Fischer, 4096R/8E24F29D bf@abenteuerland.at
+ */
+
+#include <avr/io.h>
+
+#include "avrshell.h"
+#include "parser.h"
+#include "progmem.h"
+#include "serial_io.h"
+#include "pool.h"
+#include "power.h"
+#include "adc.h"
+
+
+// timer 1 clock prescalers selected by CS12:CS10 = 1..5
+static const int prescaler_[] PROGMEM = {1, 8, 64, 256, 1024};
+
+
+/*! Setup timer 1 in CTC mode. The compare match B triggers the conversions.
+ * @param rate Sample rate in Hz.
+ */
+static void adc_timer(int rate)
+{
+   unsigned long ticks;
+   uint8_t cs;
+
+   ticks = F_CPU / rate;
+   for (cs = 0; cs < 4 && ticks / pgm_word(&prescaler_[cs]) > 0x10000; cs++);
+
+   TCCR1B = 0;
+   TCCR1A = 0;
+   OCR1A = ticks / pgm_word(&prescaler_[cs]) - 1;
+   OCR1B = 0;
+   TCNT1 = 0;
+   TIFR1 = _BV(OCF1B);
+   TCCR1B = _BV(WGM12) | (cs + 1);
+}
+
+
+/*! adc <channel> <rate_hz> <samples> */
+void cmd_adc(int8_t argc, int *argv, char *cmd)
+{
+   char *buf, hdr[8];
+   uint8_t half, n, tim1;
+   int ch, rate, cnt;
+
+   ch = argv[0];
+   rate = argv[1];
+   cnt = argv[2];
+
+   if (ch < 0 || ch >= ADC_CHANNELS || rate < 1 || rate > ADC_RATE_MAX || cnt < 1)
+   {
+      output_error(E_INVAL);
+      return;
+   }
+
+   if ((buf = pool_alloc(2 * ADC_HALF)) == NULL)
+   {
+      output_error(E_NOMEM);
+      return;
+   }
+
+   // the ADC and timer 1 may be used by another process
+   if (adc_start(buf, cnt))
+   {
+      pool_free(buf);
+      output_error(E_BUSY);
+      return;
+   }
+
+   hdr[0] = 'A';
+   hdr[1] = 'D';
+   hdr[2] = 'C';
+   hdr[3] = ch;
+   hdr[4] = rate;
+   hdr[5] = rate >> 8;
+   hdr[6] = cnt;
+   hdr[7] = cnt >> 8;
+   sys_write(hdr, sizeof(hdr));
+
+   // timer 1 is switched on if necessary
+   tim1 = PRR0 & PWR_TIM1;
+   sys_power_on(PWR_ADC | PWR_TIM1);
+   register_int(INT_NUM(ADC_vect), adc_isr);
+
+   // AVcc reference, 8 bit result, F_CPU / 128, triggered by timer 1
+   ADMUX = _BV(REFS0) | _BV(ADLAR) | (ch & 7);
+#ifdef MUX5
+   ADCSRB = (ch & 8 ? _BV(MUX5) : 0) | _BV(ADTS2) | _BV(ADTS0);
+#else
+   ADCSRB = _BV(ADTS2) | _BV(ADTS0);
+#endif
+   ADCSRA = _BV(ADEN) | _BV(ADATE) | _BV(ADIE) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+   adc_timer(rate);
+
+   for (half = 0; (n = adc_wait(half)); half ^= 1)
+   {
+      hdr[0] = 'D';
+      hdr[1] = n;
+      hdr[2] = adc_mark[half];
+      hdr[3] = adc_mark[half] >> 8;
+      sys_write(hdr, ADC_FRAME_HDR);
+      sys_write(buf + half * ADC_HALF, n);
+      adc_len[half] = 0;
+   }
+
+   sys_power_off(PWR_ADC);
+   if (tim1)
+      sys_power_off(PWR_TIM1);
+
+   println();
+   sys_send('=');
+   sys_send(' ');
+   lint_to_str(adc_lost, hdr, sizeof(hdr));
+   sys_write(hdr, strlen(hdr));
+   println();
+
+   pool_free(buf);
+}
+
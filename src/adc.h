@@ -0,0 +1,49 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ADC_H
+#define ADC_H
+
+#include "serial_io.h"
+
+// number of samples of each half of the double buffer
+#define ADC_HALF 32
+// size of frame header ('D', number of samples, lost samples)
+#define ADC_FRAME_HDR 4
+// maximum sample rate in Hz which the serial line sustains (10 bits per byte)
+#define ADC_RATE_MAX ((long) TTY_BAUD / 10 * ADC_HALF / (ADC_HALF + ADC_FRAME_HDR))
+
+#ifndef __ASSEMBLER__
+
+#include <stdint.h>
+
+// number of samples in each half, set by the interrupt handler if the half is
+// full, cleared by the process after it was sent
+extern volatile uint8_t adc_len[2];
+// number of samples lost because both halves were full
+extern volatile uint16_t adc_lost;
+// adc_lost at the 1st sample of each half
+extern uint16_t adc_mark[2];
+
+int8_t adc_start(char *, uint16_t);
+uint8_t adc_wait(uint8_t);
+void adc_isr(void);
+
+#endif
+
+#endif
+
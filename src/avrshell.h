@@ -26,13 +26,30 @@
 #define PROGMEM __attribute__((__progmem__))
 #endif
 
-#define NUM_INT_VECTS 26
+#include "mcu.h"
+
+// CPU clock of the Arduino boards
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+// interrupt number as used by register_int(), e.g. INT_NUM(TIMER2_COMPA_vect)
+#define INT_NUM(x) (x ## _num + 1)
 
 #ifndef __ASSEMBLER__
 #include <stdint.h>
 
 int8_t register_int(int8_t, void (*)(void));
 
+// shell functions (main.c)
+void println(void);
+void write_hexbyte(char);
+void write_ptr(const void *);
+void output_error(int8_t);
+int8_t get_mem_byte(const void *, int8_t);
+void mem_dump(const void *, int, int8_t);
+void exec_line(char *);
+
 #endif
 
 #endif
@@ -0,0 +1,304 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file bus.c
+ * This file contains the transactions of the TWI and SPI drivers and the
+ * commands i2c and spi.
+ *
+ * @author Bernhard R. Fischer, 4096R/8E24F29D bf@abenteuerland.at
+ */
+
+#include <avr/io.h>
+
+#include "avrshell.h"
+#include "parser.h"
+#include "process.h"
+#include "progmem.h"
+#include "serial_io.h"
+#include "timer.h"
+#include "pool.h"
+#include "power.h"
+#include "bus.h"
+
+
+static const char s_scan_[] PROGMEM = "scan";
+static const char s_read_[] PROGMEM = "read";
+static const char s_write_[] PROGMEM = "write";
+static const char s_xfer_[] PROGMEM = "xfer";
+static const char s_mode_[] PROGMEM = "mode";
+
+
+/*! Wait for the end of the transaction. The process waits on the semaphore
+ * which is posted by the interrupt handler or by a timer after BUS_TIMEOUT
+ * ticks.
+ * @return E_OK or error code.
+ */
+static int8_t bus_wait(void)
+{
+   struct timer tm;
+
+   timer_init_sem(&tm, SYS_SEM_BUS);
+   timer_start(&tm, BUS_TIMEOUT, 0);
+   while (bus_status == BUS_BUSY)
+   {
+      sys_sem_wait(SYS_SEM_BUS);
+      if (tm.state == TIMER_IDLE)
+         bus_abort();
+   }
+   timer_stop(&tm);
+
+   return bus_status;
+}
+
+
+/*! Run a TWI transaction. The bytes of buf are written to the slave, then
+ * bytes are read from it into buf.
+ * @param addr 7 bit slave address.
+ * @param buf Pointer to buffer.
+ * @param wlen Number of bytes to write.
+ * @param rlen Number of bytes to read.
+ * @return E_OK or error code.
+ */
+int8_t twi_xfer(uint8_t addr, char *buf, uint8_t wlen, uint8_t rlen)
+{
+   int8_t err;
+   uint8_t n;
+
+   bus_lock();
+   sys_power_on(PWR_TWI);
+   register_int(INT_NUM(TWI_vect), twi_isr);
+   TWBR = TWI_TWBR;
+   TWSR = 0;
+   twi_start(addr, buf, wlen, rlen);
+   err = bus_wait();
+   // let the stop condition finish
+   for (n = 0; (TWCR & _BV(TWSTO)) && n < 255; n++);
+   TWCR = 0;
+   sys_power_off(PWR_TWI);
+   bus_unlock();
+
+   return err;
+}
+
+
+/*! Run an SPI transfer with SS low. The bytes of buf are sent and replaced by
+ * the bytes received.
+ * @param buf Pointer to buffer.
+ * @param len Number of bytes (> 0).
+ * @return E_OK or error code.
+ */
+int8_t spi_xfer(char *buf, uint8_t len)
+{
+   int8_t err;
+
+   bus_lock();
+   sys_power_on(PWR_SPI);
+   register_int(INT_NUM(SPI_STC_vect), spi_isr);
+   PORTB |= _BV(SPI_SS);
+   DDRB |= _BV(SPI_SS) | _BV(SPI_SCK) | _BV(SPI_MOSI);
+   SPCR = _BV(SPIE) | _BV(SPE) | _BV(MSTR) | (spi_ctrl & 0x0f);
+   SPSR = spi_ctrl & SPI_CTRL_2X ? _BV(SPI2X) : 0;
+   PORTB &= ~_BV(SPI_SS);
+   spi_start(buf, len);
+   err = bus_wait();
+   SPCR = 0;
+   PORTB |= _BV(SPI_SS);
+   sys_power_off(PWR_SPI);
+   bus_unlock();
+
+   return err;
+}
+
+
+/*! Test if s starts with the word w in program memory. */
+static int8_t is_word(const char *s, const char *w)
+{
+   int8_t len = pstrlen(w);
+
+   return !pstrncmp(s, w, len) && (s[len] == ' ' || is_eos(s[len]));
+}
+
+
+/*! Parse the remaining integer arguments into buf.
+ * @return Number of bytes or E_INVAL if there are more than BUS_BUF_MAX.
+ */
+static int8_t get_bytes(char **cmd, char *buf)
+{
+   int8_t n;
+   int val;
+
+   for (n = 0; !get_int_param(cmd, &val); n++)
+   {
+      if (n >= BUS_BUF_MAX)
+         return E_INVAL;
+      buf[n] = val;
+   }
+   return n;
+}
+
+
+static void write_bytes(const char *buf, uint8_t n)
+{
+   for (; n; n--, buf++)
+   {
+      write_hexbyte(*buf);
+      sys_send(n > 1 ? ' ' : '\n');
+   }
+}
+
+
+/*! Parse the arguments of i2c read and write and run the transaction.
+ * @return E_OK or error code.
+ */
+static int8_t i2c_xfer(char *cmd, char *buf)
+{
+   int addr, rlen;
+   int8_t n, err;
+
+   rlen = 0;
+   if (is_word(cmd, s_read_))
+   {
+      if ((err = get_int_param(&cmd, &addr)) || (err = get_int_param(&cmd, &rlen)))
+         return err;
+      if (rlen < 1 || rlen > BUS_BUF_MAX)
+         return E_INVAL;
+   }
+   else if (is_word(cmd, s_write_))
+   {
+      if ((err = get_int_param(&cmd, &addr)))
+         return err;
+   }
+   else
+      return E_INVAL;
+
+   if ((n = get_bytes(&cmd, buf)) < 0)
+      return n;
+   if (!n && !rlen)
+      return E_NOPARM;
+   if (addr < 0 || addr > 0x7f)
+      return E_INVAL;
+
+   if (!(err = twi_xfer(addr, buf, n, rlen)))
+      write_bytes(buf, rlen);
+   return err;
+}
+
+
+/*! i2c scan
+ * i2c read <addr> <n> [<byte> ...]
+ * i2c write <addr> <byte> [<byte> ...]
+ * scan outputs the addresses of all slaves which acknowledge. read writes the
+ * bytes (e.g. the register address) and reads <n> bytes after a repeated
+ * start.
+ */
+void cmd_i2c(int8_t argc, int *argv, char *cmd)
+{
+   char *buf;
+   uint8_t addr, n;
+
+   if ((cmd = next_token(cmd)) == NULL)
+   {
+      output_error(E_NOPARM);
+      return;
+   }
+
+   if (is_word(cmd, s_scan_))
+   {
+      for (addr = 0x08, n = 0; addr < 0x78; addr++)
+         if (twi_xfer(addr, NULL, 0, 0) == E_OK)
+         {
+            write_hexbyte(addr);
+            sys_send(' ');
+            n++;
+         }
+      if (n)
+         println();
+      return;
+   }
+
+   if ((buf = pool_alloc(BUS_BUF_MAX)) == NULL)
+   {
+      output_error(E_NOMEM);
+      return;
+   }
+
+   output_error(i2c_xfer(cmd, buf));
+   pool_free(buf);
+}
+
+
+/*! spi xfer <byte> [<byte> ...]
+ * spi mode <mode> [<div>]
+ * xfer sends the bytes with SS low and outputs the bytes received. mode sets
+ * the SPI mode (0-3) and the clock divider (2, 4, ..., 128, default 16).
+ */
+void cmd_spi(int8_t argc, int *argv, char *cmd)
+{
+   char *buf;
+   int mode, div;
+   int8_t n, err;
+
+   if ((cmd = next_token(cmd)) == NULL)
+   {
+      output_error(E_NOPARM);
+      return;
+   }
+
+   if (is_word(cmd, s_mode_))
+   {
+      if ((err = get_int_param(&cmd, &mode)))
+      {
+         output_error(err);
+         return;
+      }
+      div = 16;
+      get_int_param(&cmd, &div);
+      // log2 of divider
+      for (n = 0; n < 8 && (1 << n) != div; n++);
+      if (mode < 0 || mode > 3 || n < 1 || n > 7)
+      {
+         output_error(E_INVAL);
+         return;
+      }
+      // SPR1:SPR0 = (n - 1) / 2, SPI2X doubles the clock except for 128
+      spi_ctrl = mode << CPHA | (n - 1) >> 1;
+      if (n & 1 && n < 7)
+         spi_ctrl |= SPI_CTRL_2X;
+      return;
+   }
+
+   if (!is_word(cmd, s_xfer_))
+   {
+      output_error(E_INVAL);
+      return;
+   }
+
+   if ((buf = pool_alloc(BUS_BUF_MAX)) == NULL)
+   {
+      output_error(E_NOMEM);
+      return;
+   }
+
+   if ((n = get_bytes(&cmd, buf)) <= 0)
+      err = n ? n : E_NOPARM;
+   else if (!(err = spi_xfer(buf, n)))
+      write_bytes(buf, n);
+
+   output_error(err);
+   pool_free(buf);
+}
+
@@ -0,0 +1,73 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BUS_H
+#define BUS_H
+
+// TWI clock in Hz and resulting bit rate register (prescaler 1)
+#define TWI_FREQ 100000
+#define TWI_TWBR ((F_CPU / TWI_FREQ - 16) / 2)
+// timeout of a transaction in ticks (about 110ms)
+#define BUS_TIMEOUT 7
+// maximum number of bytes of a transaction of the commands i2c and spi
+#define BUS_BUF_MAX 32
+// bus_status while a transaction is running
+#define BUS_BUSY 1
+// no process owns the bus drivers
+#define BUS_FREE 0xff
+
+// TWI status codes (TWSR & 0xf8) of master mode
+#define TWS_START 0x08
+#define TWS_REP_START 0x10
+#define TWS_MT_SLA_ACK 0x18
+#define TWS_MT_SLA_NACK 0x20
+#define TWS_MT_DATA_ACK 0x28
+#define TWS_MT_DATA_NACK 0x30
+#define TWS_MR_SLA_ACK 0x40
+#define TWS_MR_SLA_NACK 0x48
+#define TWS_MR_DATA_ACK 0x50
+#define TWS_MR_DATA_NACK 0x58
+
+// default SPI setting: mode 0, F_CPU / 16
+#define SPI_CTRL_INIT _BV(SPR0)
+// SPI2X is kept in bit 7 of spi_ctrl, the bits 0-3 are those of SPCR
+#define SPI_CTRL_2X 0x80
+
+#ifndef __ASSEMBLER__
+
+#include <stdint.h>
+
+// E_OK or error code of the last transaction, BUS_BUSY while it is running
+extern volatile int8_t bus_status;
+// SPI mode and clock divider
+extern uint8_t spi_ctrl;
+
+void bus_lock(void);
+void bus_unlock(void);
+void bus_abort(void);
+void twi_start(uint8_t, char *, uint8_t, uint8_t);
+void twi_isr(void);
+void spi_start(char *, uint8_t);
+void spi_isr(void);
+
+int8_t twi_xfer(uint8_t, char *, uint8_t, uint8_t);
+int8_t spi_xfer(char *, uint8_t);
+
+#endif
+
+#endif
+
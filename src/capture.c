@@ -0,0 +1,167 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file capture.c
+ * Logic analyzer: sample an IO port into a RAM buffer and send it run-length
+ * encoded to the host. The binary output starts with the magic "CAP" followed
+ * by the sample rate in kHz, the number of samples and the number of runs (all
+ * 16 bit little endian). Then follow the runs as pairs of <value> <count>.
+ * tools/cap2vcd.py converts this into a VCD file.
+ *
+ * @author Bernhard R. Fischer, 4096R/8E24F29D bf@abenteuerland.at
+ */
+
+#include <avr/io.h>
+
+#include "avrshell.h"
+#include "parser.h"
+#include "process.h"
+#include "progmem.h"
+#include "serial_io.h"
+#include "timer.h"
+#include "pool.h"
+#include "power.h"
+#include "capture.h"
+
+
+// timer 2 clock prescalers selected by CS22:CS20 = 1..7
+static const int prescaler_[] PROGMEM = {1, 8, 32, 64, 128, 256, 1024};
+
+
+
+/*! Setup timer 2 in CTC mode as sample clock.
+ * @param rate Sample rate in kHz.
+ */
+static void capture_timer(int rate)
+{
+   unsigned long ticks;
+   uint8_t cs;
+   int p;
+
+   ticks = F_CPU / 1000 / rate;
+   for (cs = 0; cs < 6; cs++)
+   {
+      p = pgm_word(&prescaler_[cs]);
+      if (ticks / p <= 256)
+         break;
+   }
+   p = pgm_word(&prescaler_[cs]);
+
+   TCCR2B = 0;
+   TCCR2A = _BV(WGM21);
+   OCR2A = ticks / p - 1;
+   TCNT2 = 0;
+   TCCR2B = cs + 1;
+}
+
+
+/*! Send the run-length encoded samples. */
+static void capture_dump(const char *buf, int n, int rate)
+{
+   char hdr[9];
+   int i, runs;
+   uint8_t cnt;
+
+   for (i = 1, runs = n ? 1 : 0, cnt = 1; i < n; i++, cnt++)
+      if (buf[i] != buf[i - 1] || cnt == 255)
+      {
+         runs++;
+         cnt = 0;
+      }
+
+   hdr[0] = 'C';
+   hdr[1] = 'A';
+   hdr[2] = 'P';
+   hdr[3] = rate;
+   hdr[4] = rate >> 8;
+   hdr[5] = n;
+   hdr[6] = n >> 8;
+   hdr[7] = runs;
+   hdr[8] = runs >> 8;
+   sys_write(hdr, sizeof(hdr));
+
+   for (i = 1, cnt = 1; i <= n; i++, cnt++)
+      if (i == n || buf[i] != buf[i - 1] || cnt == 255)
+      {
+         hdr[0] = buf[i - 1];
+         hdr[1] = cnt;
+         sys_write(hdr, 2);
+         cnt = 0;
+      }
+}
+
+
+/*! capture <io_reg> <rate_khz> <samples> [<trigger_mask>] */
+void cmd_capture(int8_t argc, int *argv, char *cmd)
+{
+   const volatile char *pin;
+   char *buf;
+   unsigned long t;
+   int n, rate;
+   uint8_t mask, tim2;
+
+   pin = (const volatile char*) (argv[0] + 0x20);
+   rate = argv[1];
+   n = argv[2];
+   mask = argc > 3 ? argv[3] : 0;
+
+   if (argv[0] < 0 || argv[0] > 0x3f || rate < 1 || rate > CAPTURE_RATE_MAX || n < 1 || n > CAPTURE_SIZE)
+   {
+      output_error(E_INVAL);
+      return;
+   }
+
+   if ((buf = pool_alloc(n)) == NULL)
+   {
+      output_error(E_NOMEM);
+      return;
+   }
+
+   // timer 2 is switched on if necessary
+   tim2 = PRR0 & PWR_TIM2;
+   sys_power_on(PWR_TIM2);
+   capture_timer(rate);
+
+   if (rate > CAPTURE_ISR_MAX)
+   {
+      n = capture_poll(pin, buf, n, mask);
+   }
+   else
+   {
+      register_int(INT_NUM(TIMER2_COMPA_vect), capture_isr);
+      capture_start(pin, buf, n, mask);
+      for (t = get_uptime(); capture_count() && get_uptime() - t < CAPTURE_TIMEOUT;)
+         sys_schedule();
+      capture_stop();
+      n -= capture_count();
+   }
+
+   TCCR2B = 0;
+   if (tim2)
+      sys_power_off(PWR_TIM2);
+
+   if (n)
+   {
+      capture_dump(buf, n, rate);
+      println();
+   }
+   else
+      output_error(E_TIMEOUT);
+
+   pool_free(buf);
+}
+
@@ -0,0 +1,44 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+// maximum number of samples, the buffer is allocated from the memory pool
+#define CAPTURE_SIZE 256
+// maximum sample rate in kHz
+#define CAPTURE_RATE_MAX 1000
+// maximum sample rate in kHz which is sampled by the interrupt handler, above
+// interrupts are disabled and the timer is polled
+#define CAPTURE_ISR_MAX 20
+// timeout in ticks for the interrupt driven capture (about 10s)
+#define CAPTURE_TIMEOUT 610
+
+#ifndef __ASSEMBLER__
+
+#include <stdint.h>
+
+int capture_poll(const volatile char *pin, char *buf, int n, uint8_t mask);
+void capture_start(const volatile char *pin, char *buf, int n, uint8_t mask);
+void capture_stop(void);
+int capture_count(void);
+void capture_isr(void);
+
+#endif
+
+#endif
+
@@ -0,0 +1,126 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file crc.c
+ * This file contains the commands crc and sync.
+ *
+ * sync compares a memory region block by block with the checksums sent by the
+ * host. After the command the host sends the CRC16 of every block, several
+ * separated by spaces on one line. The device answers every line with "." on
+ * a line of its own after it dumped all blocks of this line which differ. At
+ * the end it outputs "= <number of differing blocks>". An empty line aborts.
+ *
+ * @author Bernhard R. Fischer, 4096R/8E24F29D bf@abenteuerland.at
+ */
+
+#include "avrshell.h"
+#include "parser.h"
+#include "serial_io.h"
+#include "memops.h"
+#include "pool.h"
+#include "crc.h"
+
+
+static void write_crc(uint16_t crc)
+{
+   sys_send('0');
+   sys_send('x');
+   write_ptr((void*) crc);
+}
+
+
+/*! crc <addr> <len> */
+void cmd_crc(int8_t argc, int *argv, char *cmd)
+{
+   int addr, len;
+   int8_t type, err;
+
+   if ((err = get_mem_param(&cmd, &addr, &type)) || (err = get_int_param(&cmd, &len)))
+   {
+      output_error(err);
+      return;
+   }
+
+   write_crc(crc16((void*) addr, type, len, CRC16_INIT));
+   println();
+}
+
+
+/*! sync <addr> <len> <blocksize> */
+void cmd_sync(int8_t argc, int *argv, char *cmd)
+{
+   int addr, len, blk, nblk, i, bl, diff;
+   int8_t type, err;
+   uint8_t n, mode;
+   char *s, *sbuf;
+
+   if ((err = get_mem_param(&cmd, &addr, &type)) || (err = get_int_param(&cmd, &len)) || (err = get_int_param(&cmd, &blk)))
+   {
+      output_error(err);
+      return;
+   }
+
+   if (blk <= 0 || len <= 0)
+   {
+      output_error(E_INVAL);
+      return;
+   }
+
+   if ((sbuf = pool_alloc(SYNC_LINE_MAX)) == NULL)
+   {
+      output_error(E_NOMEM);
+      return;
+   }
+
+   // the CRCs sent by the host are not echoed
+   mode = sys_tty_mode(-1);
+   sys_tty_mode(mode & ~TTY_ECHO);
+
+   nblk = (len + blk - 1) / blk;
+   for (i = 0, diff = 0; i < nblk;)
+   {
+      n = sys_read(sbuf, SYNC_LINE_MAX - 1);
+      sbuf[n] = '\0';
+      for (s = sbuf; *s == ' '; s++);
+      if (is_eos(*s))
+         break;
+
+      for (; s != NULL && i < nblk; s = next_token(s), i++, addr += blk)
+      {
+         bl = len - i * blk < blk ? len - i * blk : blk;
+         if (crc16((void*) addr, type, bl, CRC16_INIT) != (uint16_t) asctoi(s))
+         {
+            mem_dump((void*) addr, bl, type);
+            diff++;
+         }
+      }
+
+      sys_send('.');
+      println();
+   }
+
+   sys_tty_mode(mode);
+
+   sys_send('=');
+   sys_send(' ');
+   lint_to_str(diff, sbuf, SYNC_LINE_MAX);
+   sys_write(sbuf, strlen(sbuf));
+   println();
+
+   pool_free(sbuf);
+}
+
@@ -0,0 +1,531 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file gdb.c
+ * This file contains a stub of the GDB remote serial protocol. The command
+ * `gdb <pid>` stops the process and switches the tty into raw mode, then
+ * avr-gdb can attach with `target remote <tty>`. The processes are the threads
+ * of gdb, their registers are read from the context frame which was saved on
+ * their stack by the scheduler. Memory is read and written with the m and M
+ * packets, RAM, flash and EEPROM are mapped as in avr-gdb. The packet c
+ * continues the process, Ctrl-C stops it again. Detaching continues the
+ * process and returns to the shell. A stopped process keeps its state, thus a
+ * process which waits e.g. in tsleep() still waits when it is continued.
+ *
+ * @author Bernhard R. Fischer, 4096R/8E24F29D bf@abenteuerland.at
+ */
+
+#include <avr/io.h>
+
+#include "avrshell.h"
+#include "parser.h"
+#include "progmem.h"
+#include "process.h"
+#include "serial_io.h"
+#include "memops.h"
+#include "pool.h"
+#include "gdb.h"
+
+#if GDB_PACKET_SIZE < CTX_SIZE
+#error "GDB_PACKET_SIZE too small"
+#endif
+
+static const char s_ok_[] PROGMEM = "OK";
+static const char s_packet_size_[] PROGMEM = "PacketSize=";
+static const char s_thread_[] PROGMEM = "thread:";
+static const char s_supported_[] PROGMEM = "qSupported";
+static const char s_qc_[] PROGMEM = "qC";
+static const char s_fthread_[] PROGMEM = "qfThreadInfo";
+static const char s_sthread_[] PROGMEM = "qsThreadInfo";
+static const char s_attached_[] PROGMEM = "qAttached";
+
+struct gdb
+{
+   char *pkt;                 // packet buffer
+   char rbuf[8];              // bytes read from the tty
+   uint8_t rlen, rpos;
+   uint8_t sum;               // checksum of the packet which is sent
+   uint8_t sig;               // signal of the last stop
+   pid_t pid;                 // debugged process
+   pid_t gpid;                // process of register access (Hg)
+};
+
+
+/*! Get next byte from the tty. */
+static char gdb_getc(struct gdb *gd)
+{
+   while (gd->rpos >= gd->rlen)
+   {
+      gd->rlen = sys_read(gd->rbuf, sizeof(gd->rbuf));
+      gd->rpos = 0;
+   }
+   return gd->rbuf[gd->rpos++];
+}
+
+
+/*! Receive a packet. The packet is acknowledged and stored \0-terminated to
+ * the packet buffer. Packets with a wrong checksum or which are too long are
+ * discarded.
+ * @return Returns 0 if a packet was received or GDB_INTR.
+ */
+static char gdb_recv(struct gdb *gd)
+{
+   uint8_t len, sum;
+   int8_t h, l;
+   char c;
+
+   for (;;)
+   {
+      if ((c = gdb_getc(gd)) == GDB_INTR)
+         return c;
+      if (c != '$')
+         continue;
+
+      for (len = 0, sum = 0; (c = gdb_getc(gd)) != '#'; sum += c)
+         if (len < GDB_PACKET_SIZE - 1)
+            gd->pkt[len++] = c;
+         else
+            len = GDB_PACKET_SIZE;
+
+      h = asc_to_nibble(gdb_getc(gd));
+      l = asc_to_nibble(gdb_getc(gd));
+      if (len >= GDB_PACKET_SIZE || h < 0 || l < 0 || (uint8_t) (h << 4 | l) != sum)
+      {
+         sys_send('-');
+         continue;
+      }
+
+      sys_send('+');
+      gd->pkt[len] = '\0';
+      return 0;
+   }
+}
+
+
+static void gdb_start(struct gdb *gd)
+{
+   sys_send('$');
+   gd->sum = 0;
+}
+
+
+static void gdb_end(struct gdb *gd)
+{
+   sys_send('#');
+   sys_send(nibble_to_ascx(gd->sum >> 4));
+   sys_send(nibble_to_ascx(gd->sum));
+}
+
+
+static void gdb_putc(struct gdb *gd, char c)
+{
+   gd->sum += c;
+   sys_send(c);
+}
+
+
+static void gdb_puthex(struct gdb *gd, uint8_t b)
+{
+   gdb_putc(gd, nibble_to_ascx(b >> 4));
+   gdb_putc(gd, nibble_to_ascx(b));
+}
+
+
+static void gdb_pputs(struct gdb *gd, const char *s)
+{
+   char c;
+
+   while ((c = pgm_byte(s++)))
+      gdb_putc(gd, c);
+}
+
+
+/*! Send a packet which consists of a string in program memory. */
+static void gdb_reply(struct gdb *gd, const char *s)
+{
+   gdb_start(gd);
+   gdb_pputs(gd, s);
+   gdb_end(gd);
+}
+
+
+/*! Send error reply "E<err>". */
+static void gdb_error(struct gdb *gd, uint8_t err)
+{
+   gdb_start(gd);
+   gdb_putc(gd, 'E');
+   gdb_puthex(gd, err);
+   gdb_end(gd);
+}
+
+
+/*! Parse hex number and advance the pointer. */
+static unsigned long gdb_hex(char **s)
+{
+   unsigned long n;
+   int8_t d;
+
+   for (n = 0; (d = asc_to_nibble(**s)) >= 0; (*s)++)
+      n = n << 4 | d;
+   return n;
+}
+
+
+/*! Check if a process can be debugged. The idle process and the current
+ * process (the stub itself) cannot.
+ */
+static int8_t gdb_alive(pid_t pid)
+{
+   int8_t state;
+
+   if (pid <= 0 || pid >= MAX_PROCS || pid == get_pid())
+      return 0;
+   state = get_proc_list()[pid].pstate & ~PSTATE_STOPPED;
+   return state != PSTATE_UNUSED && state != PSTATE_ZOMBIE;
+}
+
+
+/*! Send stop reply "T<sig>thread:<pid>;" or "W00" if the process exited. */
+static void gdb_stopped(struct gdb *gd)
+{
+   gdb_start(gd);
+   if (gdb_alive(gd->pid))
+   {
+      gdb_putc(gd, 'T');
+      gdb_puthex(gd, gd->sig);
+      gdb_pputs(gd, s_thread_);
+      gdb_puthex(gd, gd->pid);
+      gdb_putc(gd, ';');
+   }
+   else
+   {
+      gdb_putc(gd, 'W');
+      gdb_puthex(gd, 0);
+   }
+   gdb_end(gd);
+}
+
+
+/*! Send registers of process gpid, all (reg = -1) or a single one. The
+ * context frame is copied to the packet buffer.
+ */
+static void gdb_regs(struct gdb *gd, int8_t reg)
+{
+   uint8_t *ctx = (uint8_t*) gd->pkt;
+   unsigned long pc;
+   char *sp;
+   int8_t i, n;
+
+   if ((sp = proc_context(gd->gpid, gd->pkt)) == NULL)
+   {
+      gdb_error(gd, 1);
+      return;
+   }
+
+   gdb_start(gd);
+   for (n = reg < 0 ? 0 : reg; n < GDB_NUM_REGS; n++)
+   {
+      // ctx[0] is the byte at SP + 1
+      if (n < 32)
+         gdb_puthex(gd, ctx[CTX_REGS_OFF - 1 + 31 - n]);
+      else if (n == GDB_REG_SREG)
+         gdb_puthex(gd, ctx[CTX_SREG_OFF - 1]);
+      else if (n == GDB_REG_SP)
+      {
+         gdb_puthex(gd, (int) (sp + CTX_SIZE));
+         gdb_puthex(gd, (int) (sp + CTX_SIZE) >> 8);
+      }
+      else
+      {
+         // return address is a word address, high byte first
+         for (i = 0, pc = 0; i < PC_SIZE; i++)
+            pc = pc << 8 | ctx[CTX_PC_OFF - 1 + i];
+         pc <<= 1;
+         for (i = 0; i < 4; i++, pc >>= 8)
+            gdb_puthex(gd, pc);
+      }
+
+      if (reg >= 0)
+         break;
+   }
+   gdb_end(gd);
+}
+
+
+/*! Translate address and length of avr-gdb into address and memory type.
+ * Flash is accessible up to 64k.
+ * @return Returns the memory type or -1 if the range is invalid.
+ */
+static int8_t gdb_mem(unsigned long addr, unsigned long len, int *a)
+{
+   unsigned long end;
+   int8_t type;
+
+   if (addr >= GDB_EEP_OFF)
+   {
+      addr -= GDB_EEP_OFF;
+      end = E2END + 1UL;
+      type = MEM_EEP;
+   }
+   else if (addr >= GDB_RAM_OFF)
+   {
+      addr -= GDB_RAM_OFF;
+      end = RAMEND + 1UL;
+      type = MEM_RAM;
+   }
+   else
+   {
+      end = FLASHEND < 0xffffUL ? FLASHEND + 1UL : 0x10000UL;
+      type = MEM_PRG;
+   }
+
+   if (addr + len > end)
+      return -1;
+
+   *a = addr;
+   return type;
+}
+
+
+/*! m<addr>,<len> */
+static void gdb_read_mem(struct gdb *gd, char *s)
+{
+   unsigned long addr, len;
+   int8_t type;
+   int a;
+
+   addr = gdb_hex(&s);
+   len = *s++ == ',' ? gdb_hex(&s) : 0;
+   if (!len || len > GDB_PACKET_SIZE || (type = gdb_mem(addr, len, &a)) < 0)
+   {
+      gdb_error(gd, 1);
+      return;
+   }
+
+   gdb_start(gd);
+   for (; len; len--, a++)
+      gdb_puthex(gd, get_mem_byte((void*) a, type));
+   gdb_end(gd);
+}
+
+
+/*! M<addr>,<len>:<data>. Flash cannot be written. */
+static void gdb_write_mem(struct gdb *gd, char *s)
+{
+   unsigned long addr, len;
+   int8_t type, h, l;
+   int a;
+
+   addr = gdb_hex(&s);
+   len = *s++ == ',' ? gdb_hex(&s) : 0;
+   if (*s++ != ':' || !len || (type = gdb_mem(addr, len, &a)) < 0 || type == MEM_PRG)
+   {
+      gdb_error(gd, 1);
+      return;
+   }
+
+   for (; len; len--, a++, s += 2)
+   {
+      if ((h = asc_to_nibble(s[0])) < 0 || (l = asc_to_nibble(s[1])) < 0)
+      {
+         gdb_error(gd, 1);
+         return;
+      }
+      if (type == MEM_EEP)
+         write_eeprom((void*) a, h << 4 | l);
+      else
+         *((char*) a) = h << 4 | l;
+   }
+
+   gdb_reply(gd, s_ok_);
+}
+
+
+/*! Handle query packets. Unknown queries get an empty reply. */
+static void gdb_query(struct gdb *gd, const char *s)
+{
+   pid_t pid;
+   char sep;
+
+   gdb_start(gd);
+   if (!pstrncmp(s, s_supported_, sizeof(s_supported_) - 1))
+   {
+      gdb_pputs(gd, s_packet_size_);
+      gdb_puthex(gd, GDB_PACKET_SIZE);
+   }
+   else if (!pstrncmp(s, s_qc_, sizeof(s_qc_)))
+   {
+      gdb_putc(gd, 'Q');
+      gdb_putc(gd, 'C');
+      gdb_puthex(gd, gd->pid);
+   }
+   else if (!pstrncmp(s, s_fthread_, sizeof(s_fthread_)))
+   {
+      // the threads are the processes, all are sent in one reply
+      for (pid = 1, sep = 'm'; pid < MAX_PROCS; pid++)
+         if (gdb_alive(pid))
+         {
+            gdb_putc(gd, sep);
+            gdb_puthex(gd, pid);
+            sep = ',';
+         }
+      if (sep == 'm')
+         gdb_putc(gd, 'l');
+   }
+   else if (!pstrncmp(s, s_sthread_, sizeof(s_sthread_)))
+      gdb_putc(gd, 'l');
+   else if (!pstrncmp(s, s_attached_, sizeof(s_attached_)))
+      gdb_putc(gd, '1');
+   gdb_end(gd);
+}
+
+
+/*! Continue the process until gdb requests to stop it (Ctrl-C). A waiting
+ * process keeps waiting.
+ */
+static void gdb_continue(struct gdb *gd)
+{
+   cont_proc(gd->pid);
+   while (gdb_recv(gd) != GDB_INTR);
+   stop_proc(gd->pid);
+   gd->sig = GDB_SIGINT;
+   gdb_stopped(gd);
+}
+
+
+/*! Process packets until gdb detaches or kills the process. */
+static void gdb_session(struct gdb *gd)
+{
+   unsigned long n;
+   char *s;
+   pid_t pid;
+
+   for (;;)
+   {
+      if (gdb_recv(gd) == GDB_INTR)
+      {
+         gdb_stopped(gd);
+         continue;
+      }
+
+      s = gd->pkt + 1;
+      switch (gd->pkt[0])
+      {
+         case '?':
+            gdb_stopped(gd);
+            break;
+
+         case 'g':
+            gdb_regs(gd, -1);
+            break;
+
+         case 'p':
+            if ((n = gdb_hex(&s)) < GDB_NUM_REGS)
+               gdb_regs(gd, n);
+            else
+               gdb_error(gd, 1);
+            break;
+
+         case 'm':
+            gdb_read_mem(gd, s);
+            break;
+
+         case 'M':
+            gdb_write_mem(gd, s);
+            break;
+
+         case 'H':
+            // thread for registers (g), continue (c) always runs gd->pid
+            s++;
+            pid = *s == '-' ? -1 : (pid_t) gdb_hex(&s);
+            if (pid <= 0)
+               pid = gd->pid;
+            if (!gdb_alive(pid))
+            {
+               gdb_error(gd, 1);
+               break;
+            }
+            if (gd->pkt[1] == 'g')
+               gd->gpid = pid;
+            gdb_reply(gd, s_ok_);
+            break;
+
+         case 'T':
+            if (gdb_alive((pid_t) gdb_hex(&s)))
+               gdb_reply(gd, s_ok_);
+            else
+               gdb_error(gd, 1);
+            break;
+
+         case 'q':
+            gdb_query(gd, gd->pkt);
+            break;
+
+         case 'c':
+            gdb_continue(gd);
+            break;
+
+         case 'D':
+            gdb_reply(gd, s_ok_);
+            cont_proc(gd->pid);
+            return;
+
+         case 'k':
+            kill_proc(gd->pid);
+            return;
+
+         default:
+            // unsupported packet
+            gdb_start(gd);
+            gdb_end(gd);
+      }
+   }
+}
+
+
+/*! gdb <pid>
+ * Stop the process and debug it with avr-gdb on the tty of the shell.
+ */
+void cmd_gdb(int8_t argc, int *argv, char *cmd)
+{
+   struct gdb gd;
+   uint8_t mode;
+
+   if (argv[0] >= MAX_PROCS || !gdb_alive(argv[0]))
+   {
+      output_error(E_INVAL);
+      return;
+   }
+
+   if ((gd.pkt = pool_alloc(GDB_PACKET_SIZE)) == NULL)
+   {
+      output_error(E_NOMEM);
+      return;
+   }
+
+   gd.pid = gd.gpid = argv[0];
+   gd.sig = GDB_SIGTRAP;
+   gd.rlen = gd.rpos = 0;
+   stop_proc(gd.pid);
+
+   mode = sys_tty_mode(TTY_RAW);
+   gdb_session(&gd);
+   sys_read_flush();
+   sys_tty_mode(mode);
+
+   pool_free(gd.pkt);
+}
@@ -0,0 +1,45 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDB_H
+#define GDB_H
+
+#include "mcu.h"
+
+// maximum size of a packet, it fits into the input ring of the tty, thus no
+// byte is lost if the process is scheduled late
+#define GDB_PACKET_SIZE KBUF_SIZE
+
+// offsets of RAM and EEPROM in the address space of avr-gdb
+#define GDB_RAM_OFF 0x800000UL
+#define GDB_EEP_OFF 0x810000UL
+
+// register numbers of avr-gdb, r0-r31 are 0-31
+#define GDB_REG_SREG 32
+#define GDB_REG_SP 33
+#define GDB_REG_PC 34
+#define GDB_NUM_REGS 35
+
+// signals of stop replies
+#define GDB_SIGINT 2
+#define GDB_SIGTRAP 5
+
+// interrupt request (Ctrl-C) sent by gdb outside of packets
+#define GDB_INTR 0x03
+
+#endif
+
@@ -0,0 +1,206 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file icp.c
+ * This file contains the commands freq and pulse which measure the signal at
+ * the input capture pin ICP1 with timer 1 (ICP4 with timer 4 on the
+ * ATmega2560, see mcu.h). The periods are measured from rising edge to rising
+ * edge, thus the resolution is 1/F_CPU. All statistics are calculated on the
+ * device.
+ *
+ * @author Bernhard R. Fischer, 4096R/8E24F29D bf@abenteuerland.at
+ */
+
+#include <avr/io.h>
+
+#include "avrshell.h"
+#include "parser.h"
+#include "progmem.h"
+#include "serial_io.h"
+#include "timer.h"
+#include "power.h"
+#include "icp.h"
+
+
+static const char s_us_[] PROGMEM = " us (";
+static const char s_to_[] PROGMEM = " - ";
+static const char s_sd_[] PROGMEM = ", sd ";
+static const char s_sdsat_[] PROGMEM = ", sd >";
+static const char s_freq_[] PROGMEM = "f = ";
+static const char s_hz_[] PROGMEM = " Hz";
+static const char s_duty_[] PROGMEM = "duty = ";
+
+
+/*! Output a number with a fixed number of decimals.
+ * @param n Number multiplied by 10^dec.
+ * @param dec Number of decimals (1-3).
+ */
+static void write_fixed(unsigned long n, uint8_t dec)
+{
+   char buf[12];
+   unsigned long div;
+   uint8_t i;
+
+   for (i = 0, div = 1; i < dec; i++, div *= 10);
+   lint_to_str(n / div, buf, sizeof(buf));
+   sys_write(buf, strlen(buf));
+   sys_send('.');
+   for (n %= div; div > 1; div /= 10)
+   {
+      sys_send('0' + n * 10 / div);
+      n %= div / 10;
+   }
+}
+
+
+/*! Output a time in timer counts as microseconds with 2 decimals. */
+static void write_us(uint64_t ticks)
+{
+   write_fixed(ticks * 100000000ULL / F_CPU, 2);
+}
+
+
+//! Integer square root.
+static unsigned long isqrt(uint64_t n)
+{
+   unsigned long r, b;
+
+   for (r = 0, b = 1UL << 31; b; b >>= 1)
+      if ((uint64_t) (r | b) * (r | b) <= n)
+         r |= b;
+   return r;
+}
+
+
+/*! Output the statistics as "<mean> us (<min> - <max>, sd <sd>)". If a
+ * deviation was limited the standard deviation is output as "sd ><sd>".
+ */
+static void write_stat(char c, const struct icp_stat *st)
+{
+   int64_t d, var;
+
+   // mean deviation from the reference
+   d = (int64_t) (st->sum - (uint64_t) st->cnt * st->ref) / st->cnt;
+   var = st->sqsum / st->cnt - d * d;
+
+   sys_send(c);
+   sys_send(' ');
+   sys_send('=');
+   sys_send(' ');
+   write_us(st->sum / st->cnt);
+   sys_pwrite(s_us_, sizeof(s_us_) - 1);
+   write_us(st->min);
+   sys_pwrite(s_to_, sizeof(s_to_) - 1);
+   write_us(st->max);
+   if (st->sat)
+      sys_pwrite(s_sdsat_, sizeof(s_sdsat_) - 1);
+   else
+      sys_pwrite(s_sd_, sizeof(s_sd_) - 1);
+   write_us(isqrt(var > 0 ? var : 0));
+   sys_send(')');
+   println();
+}
+
+
+/*! Measure the signal at the input capture pin.
+ * @param mode ICP_FREQ or ICP_PULSE.
+ * @param n Number of periods.
+ */
+static void icp_measure(uint8_t mode, int n)
+{
+   uint16_t periods;
+   uint8_t tim, idle;
+
+   if (n < 1)
+   {
+      output_error(E_INVAL);
+      return;
+   }
+
+   // the timer is switched on if necessary
+   tim = ICP_PRR & _BV(ICP_PRTIM);
+   sys_power_on(ICP_PWR);
+   register_int(INT_NUM(ICP_CAPT_vect), icp_isr);
+   register_int(INT_NUM(ICP_OVF_vect), icp_ovf_isr);
+   if (icp_start(mode, n))
+   {
+      if (tim)
+         sys_power_off(ICP_PWR);
+      output_error(E_BUSY);
+      return;
+   }
+
+   // wait until done or no period completed within the timeout
+   for (periods = 0, idle = 0; !icp_done && idle < ICP_TIMEOUT; idle++)
+   {
+      tsleep(1);
+      if (periods != icp_periods)
+      {
+         periods = icp_periods;
+         idle = 0;
+      }
+   }
+
+   icp_stop();
+   if (tim)
+      sys_power_off(ICP_PWR);
+
+   if (!icp_stat[0].cnt)
+   {
+      output_error(E_TIMEOUT);
+      return;
+   }
+
+   // frequency in mHz
+   sys_pwrite(s_freq_, sizeof(s_freq_) - 1);
+   write_fixed(F_CPU * 1000ULL * icp_stat[0].cnt / icp_stat[0].sum, 3);
+   sys_pwrite(s_hz_, sizeof(s_hz_) - 1);
+   println();
+   write_stat('T', &icp_stat[0]);
+
+   if (mode == ICP_PULSE && icp_stat[1].cnt)
+   {
+      write_stat('H', &icp_stat[1]);
+      sys_pwrite(s_duty_, sizeof(s_duty_) - 1);
+      write_fixed(icp_stat[1].sum * 1000 * icp_stat[0].cnt / (icp_stat[0].sum * icp_stat[1].cnt), 1);
+      sys_send(' ');
+      sys_send('%');
+      println();
+   }
+
+   if (!icp_done)
+      output_error(E_TIMEOUT);
+}
+
+
+/*! freq [<n>]
+ * Measure the frequency over <n> periods (default ICP_PERIODS).
+ */
+void cmd_freq(int8_t argc, int *argv, char *cmd)
+{
+   icp_measure(ICP_FREQ, argc ? argv[0] : ICP_PERIODS);
+}
+
+
+/*! pulse [<n>]
+ * Measure frequency, high time and duty cycle over <n> periods (default
+ * ICP_PERIODS).
+ */
+void cmd_pulse(int8_t argc, int *argv, char *cmd)
+{
+   icp_measure(ICP_PULSE, argc ? argv[0] : ICP_PERIODS);
+}
@@ -0,0 +1,75 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ICP_H
+#define ICP_H
+
+// measurement modes
+#define ICP_FREQ 0
+#define ICP_PULSE 1
+
+// measurement is aborted if no period completes within this time (about 2s)
+#define ICP_TIMEOUT 122
+// default number of periods
+#define ICP_PERIODS 16
+
+// offsets in struct icp_stat
+#define ICP_ST_CNT_OFF 0
+#define ICP_ST_SUM_OFF 2
+#define ICP_ST_MIN_OFF 10
+#define ICP_ST_MAX_OFF 14
+#define ICP_ST_REF_OFF 18
+#define ICP_ST_SQSUM_OFF 22
+#define ICP_ST_SAT_OFF 30
+#define ICP_ST_SIZE 31
+
+#ifndef __ASSEMBLER__
+
+#include <stdint.h>
+
+/*! Statistics of a time measured in timer counts. The squares of the
+ * deviations from the first value (ref) are summed up for the standard
+ * deviation. The deviations are limited to 24 bit (about 1s at 16MHz), sat is
+ * set if one was limited.
+ */
+struct icp_stat
+{
+   uint16_t cnt;
+   uint64_t sum;
+   uint32_t min;
+   uint32_t max;
+   uint32_t ref;
+   uint64_t sqsum;
+   uint8_t sat;
+};
+
+// statistics of the periods and the high times (ICP_PULSE only)
+extern struct icp_stat icp_stat[2];
+// number of periods measured
+extern volatile uint16_t icp_periods;
+// set if all periods are measured
+extern volatile uint8_t icp_done;
+
+int8_t icp_start(uint8_t, uint16_t);
+void icp_stop(void);
+void icp_isr(void);
+void icp_ovf_isr(void);
+
+#endif
+
+#endif
+
@@ -36,6 +36,7 @@
 #include "process.h"
 #include "avrshell.h"
 #include "timer.h"
+#include "power.h"
 
 #pragma GCC diagnostic ignored "-Wmisspelled-isr"
 
@@ -56,7 +57,7 @@ static volatile int8_t lcnt_;
 void toggle(void)
 {
    char *addr = (char*) 0x23;
-   *addr = 0x20;
+   *addr = LED_MASK;
 #ifdef USE_TIMER1
    lcnt_++;
 #endif
@@ -68,14 +69,15 @@ void led_proc_main(void)
 {
    // init PORTB (where the LED of Arduino is attached to)
    char *addr = (char*) 0x24;    // DDRB
-   *addr = 0x20;                 // set bit 5 to output
+   *addr = LED_MASK;             // set LED bit to output
 
 #ifdef USE_TIMER1
    lcnt_ = 0;
    // register interrupt
-   register_int(14, toggle);
+   register_int(INT_NUM(TIMER1_OVF_vect), toggle);
 
    // init timer 1
+   sys_power_on(PWR_TIM1);
    addr = (char*) 0x80;          // TCCR1A
    *addr = 0;
    addr = (char*) 0x81;          // TCCR1B
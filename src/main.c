@@ -21,14 +21,17 @@
 #include "parser.h"
 #include "avrshell.h"
 #include "process.h"
+#include "script.h"
+#include "memops.h"
+#include "pool.h"
 
 
 #define SYS_PWRITE(x) sys_pwrite(x, sizeof(x) - 1)
 #define PSTRNCMP(x, y) pstrncmp(x, y, sizeof(y) - 1)
 
-#define MEM_RAM 0
-#define MEM_PRG 1
-#define MEM_EEP 3
+// size of the command line buffer of a shell
+#define SHELL_LINE_MAX 64
+
 
 static const char m_helo_[] PROGMEM = "AVR shell v2.0 (c) 2019-2020 Bernhard Fischer, <bf@abenteuerland.at>";
 static const char m_prompt_[] __attribute__((__progmem__)) = "Arduino# ";
@@ -37,6 +40,13 @@ static const char m_unk_[] PROGMEM = "*** unknown command";
 static const char m_unk_err_[] PROGMEM = "*** error unknown";
 static const char m_miss_arg_[] PROGMEM = "*** missing arg";
 static const char m_null_[] PROGMEM = "** NULL pointer";
+static const char m_inval_[] PROGMEM = "*** invalid arg";
+static const char m_nomem_[] PROGMEM = "*** out of memory";
+static const char m_timeout_[] PROGMEM = "*** timeout";
+static const char m_verify_[] PROGMEM = "*** verify failed";
+static const char m_nack_[] PROGMEM = "*** no acknowledge";
+static const char m_bus_[] PROGMEM = "*** bus error";
+static const char m_busy_[] PROGMEM = "*** busy";
 static const char m_int_[] PROGMEM = "__INTERRUPT__ 0x";
 
 static const char s_devsig_[] PROGMEM = "device signature = ";
@@ -57,12 +67,40 @@ static const char m_help_[] PROGMEM =
    "pdump [<memaddr> [<len>]] . dump <len> bytes of program memory\n"
    "edump [<memaddr> [<len>] .. dump <len> bytes of EEPROM memory\n"
    "ste <memaddr> <byte> ...... write byte to EEPROM memory\n"
+   "ewrite <memaddr> <byte> ... write bytes to EEPROM memory\n"
    "cpu ....................... CPU info\n"
    "uptime .................... show system uptime ticks.\n"
    "run <pid> ................. run process <pid>.\n"
    "stop <pid> ................ stop process <pid>.\n"
    "new <address> ............. create new process with start routine at <address>.\n"
-   "ps ........................ show process list.\n";
+   "kill <pid> ................ kill process <pid>.\n"
+   "ps ........................ show process list.\n"
+   "shell <tty> ............... start shell on tty <tty>.\n"
+   "stty [<mode>] ............. show or set tty mode (1 = echo, 2 = line editing).\n"
+   "mem ....................... show memory pool usage.\n"
+   "power [<deep> [<mod>]] .... show sleep statistics, set power management.\n"
+   "i2c scan .................. list addresses of TWI devices\n"
+   "i2c read <a> <n> [<b>...] . write bytes <b>, read <n> bytes from TWI device <a>\n"
+   "i2c write <a> <b> [...] ... write bytes to TWI device <a>\n"
+   "spi xfer <b> [<b> ...] .... SPI transfer with SS low, show bytes received\n"
+   "spi mode <mode> [<div>] ... set SPI mode (0-3) and clock divider (2-128)\n"
+   "watch <addr> [<len> ...] .. watch memory in background.\n"
+   "capture <reg> <khz> <n> ... sample IO port (logic analyzer).\n"
+   "adc <ch> <hz> <n> ......... stream ADC samples (binary frames).\n"
+   "pinwait <p> <mask> [<n>] .. wait for pin changes of pin change interrupt <p>.\n"
+   "freq [<n>] ................ measure frequency at ICP1/ICP4 over <n> periods.\n"
+   "pulse [<n>] ............... measure frequency, high time, and duty cycle.\n"
+   "gdb <pid> ................. debug process with avr-gdb (remote protocol).\n"
+   "def <name> <cmd;...> ...... define macro in EEPROM, 'autorun' runs at boot.\n"
+   "undef <name> .............. delete macro.\n"
+   "macros .................... list macros.\n"
+   "fill <addr> <len> <byte> .. fill memory, <addr> may be prefixed by r:, p:, e:\n"
+   "copy <src> <dst> <len> .... copy memory (also between memory types)\n"
+   "cmp <addr> <addr> <len> ... compare memory, show differences\n"
+   "find <addr> <len> <pat> ... find bytes or \"string\" in memory\n"
+   "crc <addr> <len> .......... calculate CRC16 of memory\n"
+   "sync <addr> <len> <blk> ... compare blocks with CRC16s sent by host\n"
+   "upload .................... program Intel HEX into flash\n";
 
 
 void println(void)
@@ -213,6 +251,41 @@ void output_error(int8_t err)
          SYS_PWRITE(m_miss_arg_);
          println();
          break;
+
+      case E_INVAL:
+         SYS_PWRITE(m_inval_);
+         println();
+         break;
+
+      case E_NOMEM:
+         SYS_PWRITE(m_nomem_);
+         println();
+         break;
+
+      case E_TIMEOUT:
+         SYS_PWRITE(m_timeout_);
+         println();
+         break;
+
+      case E_VERIFY:
+         SYS_PWRITE(m_verify_);
+         println();
+         break;
+
+      case E_NACK:
+         SYS_PWRITE(m_nack_);
+         println();
+         break;
+
+      case E_BUS:
+         SYS_PWRITE(m_bus_);
+         println();
+         break;
+
+      case E_BUSY:
+         SYS_PWRITE(m_busy_);
+         println();
+         break;
  
       default:
          SYS_PWRITE(m_unk_err_);
@@ -222,17 +295,6 @@ void output_error(int8_t err)
 }
 
 
-int8_t get_int_param0(char **cmd, int *parm)
-{
-   int8_t err;
-
-   err = get_int_param(cmd, parm);
-   output_error(err);
-
-   return err;
-}
-
-
 void ser_pwrite(const char *buf, int len)
 {
    uint8_t wlen;
@@ -288,205 +350,403 @@ void ps(void)
          sys_send(' ');
          lint_to_str(pe->pstate, buf, sizeof(buf));
          sys_write(buf, strlen(buf));
+         sys_send(' ');
+         lint_to_str(pe->tty, buf, sizeof(buf));
+         sys_write(buf, strlen(buf));
          println();
       }
    }
 }
 
 
-int main(void)
+void cmd_lds(int8_t argc, int *argv, char *cmd)
 {
-   unsigned char rlen;
-   static char buf[32], *cmd;   //FIXME: moved to main memory, buffer too large on stack
-   int addr, off;
-   int val;
-   int8_t cmdnr, byte, err;
+   int8_t val;
 
-   init_serial();
-   println();
-   SYS_PWRITE(m_helo_);
+   val = *((char*) argv[0]);
+
+   sys_send('0');
+   sys_send('x');
+   write_hexbyte(val);
    println();
- 
-   for (;;)
+}
+
+
+void cmd_sts(int8_t argc, int *argv, char *cmd)
+{
+   *((char*) argv[0]) = argv[1];
+}
+
+
+void cmd_in(int8_t argc, int *argv, char *cmd)
+{
+   argv[0] += 0x20;
+   cmd_lds(argc, argv, cmd);
+}
+
+
+void cmd_out(int8_t argc, int *argv, char *cmd)
+{
+   argv[0] += 0x20;
+   cmd_sts(argc, argv, cmd);
+}
+
+
+static void dump(int8_t argc, int *argv, int8_t type)
+{
+   int addr = 0, len = 512;
+
+   if (argc > 0)
+      addr = argv[0];
+   if (argc > 1)
+      len = argv[1];
+
+   mem_dump((void*) addr, len, type);
+}
+
+
+void cmd_dump(int8_t argc, int *argv, char *cmd)
+{
+   dump(argc, argv, MEM_RAM);
+}
+
+
+void cmd_pdump(int8_t argc, int *argv, char *cmd)
+{
+   dump(argc, argv, MEM_PRG);
+}
+
+
+void cmd_edump(int8_t argc, int *argv, char *cmd)
+{
+   dump(argc, argv, MEM_EEP);
+}
+
+
+void cmd_sbi(int8_t argc, int *argv, char *cmd)
+{
+   sbi((char*) argv[0] + 0x20, argv[1]);
+}
+
+
+void cmd_cbi(int8_t argc, int *argv, char *cmd)
+{
+   cbi((char*) argv[0] + 0x20, argv[1]);
+}
+
+
+void cmd_ste(int8_t argc, int *argv, char *cmd)
+{
+   write_eeprom((char*) argv[0], argv[1]);
+}
+
+
+void cmd_ewrite(int8_t argc, int *argv, char *cmd)
+{
+   int addr, val;
+
+   if (get_int_param(&cmd, &addr) || get_int_param(&cmd, &val))
    {
-      SYS_PWRITE(m_prompt_);
-      sys_read_flush();
-      if (!(rlen = sys_read(buf, sizeof(buf) - 1)))
-         continue;
-      cmd = buf;
-      buf[rlen] = '\0';
-      // skip leading spaces
-      for (; *cmd == ' '; cmd++);
-      if (*cmd == '#' || is_eos(*cmd))
-         continue;
+      output_error(E_NOPARM);
+      return;
+   }
 
-      cmdnr = get_command(cmd, rlen);
-      off = 0;
+   do
+      write_eeprom((char*) addr++, val);
+   while (!get_int_param(&cmd, &val));
+}
 
-      switch (cmdnr)
-      {
-         // lds
-         // in
-         case C_IN:
-            off = 0x20;
 
-         case C_LDS:
-            if (get_int_param0(&cmd, &addr))
-               break;
+void cmd_cpu(int8_t argc, int *argv, char *cmd)
+{
+   int8_t byte;
 
-            addr += off;
+   SYS_PWRITE(s_devsig_);
+   byte = read_sig(0);
+   write_hexbyte(byte);
+   sys_send(' ');
+   byte = read_sig(2);
+   write_hexbyte(byte);
+   sys_send(' ');
+   byte = read_sig(4);
+   write_hexbyte(byte);
+   println();
 
-            val = *((char*)(addr));
+   SYS_PWRITE(s_oscal_);
+   byte = read_sig(1);
+   write_hexbyte(byte);
+   println();
 
-            sys_send('0');
-            sys_send('x');
-            write_hexbyte(val);
-            println();
+   print_fuse(1, s_blb_);
+   print_fuse(0, s_fl_);
+   print_fuse(3, s_fh_);
+   print_fuse(2, s_ef_);
+}
 
-            break;
 
-         // out
-         case C_OUT:
-            off = 0x20;
+void cmd_uptime(int8_t argc, int *argv, char *cmd)
+{
+   char buf[12];
 
-         case C_STS:
-            if (get_int_param0(&cmd, &addr))
-               break;
-            if (get_int_param0(&cmd, &val))
-               break;
+   lint_to_str(get_uptime(), buf, sizeof(buf));
+   sys_write(buf, strlen(buf));
+   println();
+}
 
-            *((char*)(addr + off)) = val;
 
-            break;
+void cmd_run(int8_t argc, int *argv, char *cmd)
+{
+   // continue a stopped process, start a new one
+   cont_proc(argv[0]);
+   if (argv[0] >= 0 && argv[0] < MAX_PROCS && get_proc_list()[argv[0]].pstate == PSTATE_NEW)
+      run_proc(argv[0]);
+}
 
-         //edump
-         case C_EDUMP:
-            off |= MEM_EEP;
-
-         //pdump
-         case C_PDUMP:
-            off |= MEM_PRG;
-
-         //dump
-         case C_DUMP:
-            if ((err = get_int_param(&cmd, &addr)))
-            {
-               if (err != E_NOPARM)
-               {
-                  output_error(err);
-                  break;
-               }
-               addr = 0;
-            }
-
-            val = 512;
-            get_int_param(&cmd, &val);
-            mem_dump((void*) addr, val, off);
 
-            break;
+void cmd_stop(int8_t argc, int *argv, char *cmd)
+{
+   stop_proc(argv[0]);
+}
 
-         //sbi
-         case C_SBI:
-            if (get_int_param0(&cmd, &addr))
-               break;
-            if (get_int_param0(&cmd, &val))
-               break;
 
-            addr += 0x20;
-            sbi((char*) addr, val);
+void cmd_kill(int8_t argc, int *argv, char *cmd)
+{
+   kill_proc(argv[0]);
+}
 
-            break;
 
-         //cbi
-         case C_CBI:
-            if (get_int_param0(&cmd, &addr))
-               break;
-            if (get_int_param0(&cmd, &val))
-               break;
+void cmd_new(int8_t argc, int *argv, char *cmd)
+{
+   char buf[4];
+   pid_t pid;
 
-            addr += 0x20;
-            cbi((char*) addr, val);
+   // program addresses are word addresses on AVR
+   pid = new_proc((void (*)(void)) (argv[0] >> 1));
+   lint_to_str(pid, buf, sizeof(buf));
+   sys_write(buf, strlen(buf));
+   println();
+}
 
-            break;
 
-         //ste
-         case C_STE:
-            if (get_int_param0(&cmd, &addr))
-               break;
-            if (get_int_param0(&cmd, &val))
-               break;
+static void shell_proc(void);
 
-            write_eeprom((char*) addr, val);
+// pid of the shell of each tty, 0 if none was started (pid 0 is the idle
+// process), it is valid only as long as the process is alive on the tty
+static pid_t shell_pid_[NUM_TTYS];
 
-            break;
-         
-         case C_CPU:
-            SYS_PWRITE(s_devsig_);
-            byte = read_sig(0);
-            write_hexbyte(byte);
-            sys_send(' ');
-            byte = read_sig(2);
-            write_hexbyte(byte);
-            sys_send(' ');
-            byte = read_sig(4);
-            write_hexbyte(byte);
-            println();
 
-            SYS_PWRITE(s_oscal_);
-            byte = read_sig(1);
-            write_hexbyte(byte);
-            println();
+/*! Start a new shell process on a tty. Only one shell at a time may read a
+ * tty.
+ */
+void cmd_shell(int8_t argc, int *argv, char *cmd)
+{
+   struct plist_entry *pe;
+   char buf[4];
+   pid_t pid;
 
-            print_fuse(1, s_blb_);
-            print_fuse(0, s_fl_);
-            print_fuse(3, s_fh_);
-            print_fuse(2, s_ef_);
-            break;
+   if (argv[0] < 0 || argv[0] >= NUM_TTYS)
+   {
+      output_error(E_INVAL);
+      return;
+   }
 
-         case C_UPTIME:
-            lint_to_str(get_uptime(), buf, sizeof(buf));
-            sys_write(buf, strlen(buf));
-            println();
-            break;
+   pe = get_proc_list() + shell_pid_[argv[0]];
+   if (shell_pid_[argv[0]] && pe->pstate != PSTATE_UNUSED && pe->tty == argv[0])
+   {
+      output_error(E_BUSY);
+      return;
+   }
 
-         case C_RUN:
-            if (get_int_param0(&cmd, &addr))
-               break;
-            run_proc(addr);
-            break;
+   if ((pid = new_proc(shell_proc)) == -1)
+   {
+      output_error(E_NOMEM);
+      return;
+   }
+
+   get_proc_list()[pid].tty = argv[0];
+   shell_pid_[argv[0]] = pid;
+   sys_tty_open(argv[0]);
+   run_proc(pid);
 
-         case C_STOP:
-            if (get_int_param0(&cmd, &addr))
-               break;
-            stop_proc(addr);
+   lint_to_str(pid, buf, sizeof(buf));
+   sys_write(buf, strlen(buf));
+   println();
+}
+
+
+/*! Show or set the mode of the tty of the current shell.
+ */
+void cmd_stty(int8_t argc, int *argv, char *cmd)
+{
+   char buf[4];
+   uint8_t mode;
+
+   mode = sys_tty_mode(argc ? argv[0] & (TTY_ECHO | TTY_LEDIT) : -1);
+   if (argc)
+      return;
+
+   lint_to_str(mode, buf, sizeof(buf));
+   sys_write(buf, strlen(buf));
+   println();
+}
+
+
+void cmd_ps(int8_t argc, int *argv, char *cmd)
+{
+   ps();
+}
+
+
+void cmd_help(int8_t argc, int *argv, char *cmd)
+{
+   help();
+}
+
+
+/*! Execute a single command. The integer arguments are parsed according to the
+ * argument specification of the command table before the handler is called.
+ * If the command does not exist, a macro with this name is executed.
+ * @param ce Pointer to the command table entry (in program memory) or NULL.
+ * @param cmd Pointer to the \0-terminated command without leading spaces.
+ */
+static void exec_command(const struct cmd_entry *ce, char *cmd)
+{
+   cmd_func_t func;
+   int argv[CMD_MAXARGS];
+   int8_t argc, args, max;
+   char *s;
+
+   if (ce == NULL)
+   {
+      switch (script_exec(cmd))
+      {
+         case E_OK:
             break;
 
-          case C_NEW:
-            if (get_int_param0(&cmd, &addr))
-               break;
-            addr >>= 1;    // program addresses are word addresses on AVR
-            pid_t pid = new_proc((void (*)(void)) addr);
-            lint_to_str(pid, buf, sizeof(buf));
-            sys_write(buf, strlen(buf));
+         case E_NOPARM:
+            SYS_PWRITE(m_unk_);
             println();
             break;
- 
-          case C_PS:
-            ps();
-            break;
 
-         case C_HELP:
-            help();
+         default:
+            output_error(E_NOMEM);
+      }
+      return;
+   }
+
+   func = (cmd_func_t) pgm_ptr(&ce->func);
+   args = pgm_byte(&ce->args);
+   max = CMD_ARGS_MAX(args);
+   if (max > CMD_MAXARGS)
+      max = 0;
+
+   for (argc = 0; argc < max; argc++)
+   {
+      s = cmd;
+      if (get_int_param(&s, &argv[argc]))
+         break;
+      cmd = s;
+   }
+
+   if (argc < CMD_ARGS_MIN(args))
+   {
+      output_error(E_NOPARM);
+      return;
+   }
+
+   func(argc, argv, cmd);
+}
+
+
+/*! Execute a command line. It may contain several commands separated by ';'.
+ * The rest of the line after '#' is ignored. Note that the line is modified.
+ * @param line Pointer to \0-terminated command line.
+ */
+void exec_line(char *line)
+{
+   const struct cmd_entry *ce;
+   char *s, c;
+
+   for (;;)
+   {
+      // skip leading spaces and empty commands
+      for (; *line == ' ' || *line == ';'; line++);
+      if (*line == '#' || is_eos(*line))
+         return;
+
+      ce = get_command(line);
+      for (s = line; !is_eos(*s); s++)
+         if (*s == ';' && (ce == NULL || CMD_ARGS_MAX(pgm_byte(&ce->args)) != CMD_LINE))
             break;
 
-         // unknown command
-         default:
-            SYS_PWRITE(m_unk_);
-            println();
-      } /* switch (cmdnr) */
+      c = *s;
+      *s = '\0';
+      exec_command(ce, line);
+      if (c != ';')
+         return;
+      line = s + 1;
    }
+}
+
+
+static void banner(void)
+{
+   println();
+   SYS_PWRITE(m_helo_);
+   println();
+}
+
+
+/*! Command loop of a shell. It reads lines from the tty of the process and
+ * executes them. The line buffer is attached to the process, thus it is freed
+ * if the shell is killed.
+ */
+static void shell(void)
+{
+   unsigned char rlen;
+   char *buf;
+
+   if ((buf = pool_alloc(SHELL_LINE_MAX)) == NULL)
+   {
+      output_error(E_NOMEM);
+      return;
+   }
+   get_proc_list()[get_pid()].data = buf;
+
+   for (;;)
+   {
+      SYS_PWRITE(m_prompt_);
+      if (!(rlen = sys_read(buf, SHELL_LINE_MAX - 1)))
+         continue;
+      buf[rlen] = '\0';
+
+      exec_line(buf);
+   }
+}
+
+
+static void shell_proc(void)
+{
+   banner();
+   shell();
+}
+
+
+int main(void)
+{
+   uint8_t i;
+
+   for (i = 1; i < NUM_TTYS; i++)
+      shell_pid_[i] = 0;
+   shell_pid_[0] = get_pid();
+
+   init_serial();
+   init_script();
+   banner();
+
+   script_autorun();
+   shell();
 
    // obligatory
    return 0;
 }
-
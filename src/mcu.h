@@ -0,0 +1,144 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file mcu.h
+ * MCU specific definitions. All differences between the supported
+ * microcontrollers are collected here. The MCU is selected in the Makefile
+ * with the variable MCU.
+ *
+ * @author Bernhard R. Fischer, 4096R/8E24F29D bf@abenteuerland.at
+ */
+
+#ifndef MCU_H
+#define MCU_H
+
+#include <avr/io.h>
+
+#if defined(__AVR_ATmega2560__)
+
+// number of interrupt vectors including reset
+#define NUM_INT_VECTS 57
+// number of USARTs
+#define NUM_USARTS 4
+// maximum number of processes
+#define MAX_PROCS 16
+// process stack size
+#define STACK_SIZE 256
+// size of serial input and output buffer
+#define KBUF_SIZE 128
+// number of ttys and their USART and channel (see serial_io.S)
+#define NUM_TTYS 5
+#define TTY_CONFIG 0,0, 0,1, 1,0, 2,0, 3,0
+// bit of LED (Arduino pin 13) in PORTB
+#define LED_MASK 0x80
+// pin change interrupt of RXD0 (PE0), wakes up from power-save mode
+#define RXD_PCINT_vect_num PCINT1_vect_num
+#define RXD_PCMSK PCMSK1
+#define RXD_PCIE PCIE1
+#define RXD_PCINT PCINT8
+// SPI pins in PORTB, SS is the chip select of the spi command
+#define SPI_SS PB0
+#define SPI_SCK PB1
+#define SPI_MOSI PB2
+// number of single ended ADC channels
+#define ADC_CHANNELS 16
+// input registers of the pin change interrupts 0-2, PCINT1 is PE0 (bit 0) and
+// PJ0-PJ6 (bits 1-7)
+#define PCINT0_PIN PINB
+#define PCINT1_PIN PINJ
+#define PCINT2_PIN PINK
+#define PCINT1_PE0
+// timer of the commands freq and pulse, ICP4 (PL0, pin 49 of the Mega) because
+// ICP1 (PD4) is not connected on the board
+#define ICP_TIMER 4
+#define ICP_TCCRA TCCR4A
+#define ICP_TCCRB TCCR4B
+#define ICP_TCNTL TCNT4L
+#define ICP_TCNTH TCNT4H
+#define ICP_ICRL ICR4L
+#define ICP_ICRH ICR4H
+#define ICP_TIFR TIFR4
+#define ICP_TIMSK TIMSK4
+#define ICP_PWR PWR_TIM4
+#define ICP_PRR PRR1
+#define ICP_PRTIM PRTIM4
+#define ICP_CAPT_vect_num TIMER4_CAPT_vect_num
+#define ICP_OVF_vect_num TIMER4_OVF_vect_num
+
+#elif defined(__AVR_ATmega328P__)
+
+#define NUM_INT_VECTS 26
+#define NUM_USARTS 1
+#define MAX_PROCS 5
+#define STACK_SIZE 128
+#define KBUF_SIZE 64
+#define NUM_TTYS 2
+#define TTY_CONFIG 0,0, 0,1
+#define LED_MASK 0x20
+#define RXD_PCINT_vect_num PCINT2_vect_num
+#define RXD_PCMSK PCMSK2
+#define RXD_PCIE PCIE2
+#define RXD_PCINT PCINT16
+#define SPI_SS PB2
+#define SPI_SCK PB5
+#define SPI_MOSI PB3
+#define ADC_CHANNELS 8
+#define PCINT0_PIN PINB
+#define PCINT1_PIN PINC
+#define PCINT2_PIN PIND
+#define ICP_TIMER 1
+#define ICP_TCCRA TCCR1A
+#define ICP_TCCRB TCCR1B
+#define ICP_TCNTL TCNT1L
+#define ICP_TCNTH TCNT1H
+#define ICP_ICRL ICR1L
+#define ICP_ICRH ICR1H
+#define ICP_TIFR TIFR1
+#define ICP_TIMSK TIMSK1
+#define ICP_PWR PWR_TIM1
+#define ICP_PRR PRR0
+#define ICP_PRTIM PRTIM1
+#define ICP_CAPT_vect_num TIMER1_CAPT_vect_num
+#define ICP_OVF_vect_num TIMER1_OVF_vect_num
+
+#else
+#error "MCU not supported"
+#endif
+
+// number of bytes of a return address on the stack
+#ifdef __AVR_3_BYTE_PC__
+#define PC_SIZE 3
+#else
+#define PC_SIZE 2
+#endif
+
+// number of registers which are saved in the process context additionally to
+// r0-r31 and SREG (RAMPZ and EIND)
+#if defined(RAMPZ) && defined(EIND)
+#define CTX_XREGS 2
+#else
+#define CTX_XREGS 0
+#endif
+
+// USART0 vectors are named differently on MCUs with several USARTs
+#ifndef USART_RX_vect_num
+#define USART_RX_vect_num USART0_RX_vect_num
+#define USART_UDRE_vect_num USART0_UDRE_vect_num
+#endif
+
+#endif
+
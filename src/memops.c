@@ -0,0 +1,230 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file memops.c
+ * This file contains the memory commands fill, copy, cmp, and find. Memory
+ * addresses may be prefixed by "r:" (RAM, default), "p:" (program memory), or
+ * "e:" (EEPROM), e.g. "e:0x20".
+ *
+ * @author Bernhard R. Fischer, 4096R/8E24F29D bf@abenteuerland.at
+ */
+
+#include "avrshell.h"
+#include "parser.h"
+#include "progmem.h"
+#include "serial_io.h"
+#include "memops.h"
+
+
+static const char m_more_[] PROGMEM = "...";
+
+
+/*! Parse memory address parameter.
+ * @param cmd Pointer to current token, it is advanced to the parameter.
+ * @param addr Pointer to variable receiving the address.
+ * @param type Pointer to variable receiving the memory type.
+ * @return E_OK on success, otherwise an error code.
+ */
+int8_t get_mem_param(char **cmd, int *addr, int8_t *type)
+{
+   char *s;
+
+   if ((s = next_token(*cmd)) == NULL)
+      return E_NOPARM;
+   *cmd = s;
+
+   *type = MEM_RAM;
+   if (s[0] && s[1] == ':')
+   {
+      switch (s[0])
+      {
+         case 'r':
+            break;
+         case 'p':
+            *type = MEM_PRG;
+            break;
+         case 'e':
+            *type = MEM_EEP;
+            break;
+         default:
+            return E_INVAL;
+      }
+      s += 2;
+   }
+
+   *addr = asctoi(s);
+   return E_OK;
+}
+
+
+static void print_more(void)
+{
+   sys_pwrite(m_more_, sizeof(m_more_) - 1);
+   println();
+}
+
+
+/*! fill <addr> <len> <byte> */
+void cmd_fill(int8_t argc, int *argv, char *cmd)
+{
+   int addr, len, val;
+   int8_t type, err;
+
+   if ((err = get_mem_param(&cmd, &addr, &type)) || (err = get_int_param(&cmd, &len)) || (err = get_int_param(&cmd, &val)))
+   {
+      output_error(err);
+      return;
+   }
+
+   if (type == MEM_PRG)
+   {
+      output_error(E_INVAL);
+      return;
+   }
+
+   mem_fill((void*) addr, type, len, val);
+}
+
+
+/*! copy <src> <dst> <len> */
+void cmd_copy(int8_t argc, int *argv, char *cmd)
+{
+   int src, dst, len;
+   int8_t stype, dtype, err;
+
+   if ((err = get_mem_param(&cmd, &src, &stype)) || (err = get_mem_param(&cmd, &dst, &dtype)) || (err = get_int_param(&cmd, &len)))
+   {
+      output_error(err);
+      return;
+   }
+
+   if (dtype == MEM_PRG)
+   {
+      output_error(E_INVAL);
+      return;
+   }
+
+   mem_copy((void*) dst, dtype, (void*) src, stype, len);
+}
+
+
+/*! cmp <addr> <addr> <len>
+ * Outputs the offset and both bytes of every difference.
+ */
+void cmd_cmp(int8_t argc, int *argv, char *cmd)
+{
+   int a, b, len, off, n;
+   int8_t ta, tb, err, cnt;
+
+   if ((err = get_mem_param(&cmd, &a, &ta)) || (err = get_mem_param(&cmd, &b, &tb)) || (err = get_int_param(&cmd, &len)))
+   {
+      output_error(err);
+      return;
+   }
+
+   for (off = 0, cnt = 0; off < len; off++)
+   {
+      n = mem_cmp((void*) (a + off), ta, (void*) (b + off), tb, len - off);
+      if ((off += n) >= len)
+         break;
+
+      if (cnt++ >= MEM_RESULTS_MAX)
+      {
+         print_more();
+         break;
+      }
+
+      write_ptr((void*) off);
+      sys_send(':');
+      sys_send(' ');
+      write_hexbyte(get_mem_byte((void*) (a + off), ta));
+      sys_send(' ');
+      write_hexbyte(get_mem_byte((void*) (b + off), tb));
+      println();
+   }
+}
+
+
+/*! Parse search pattern. It is either a list of bytes or a string enclosed
+ * in double quotes.
+ * @return Returns the length of the pattern, 0 if there is no pattern.
+ */
+static uint8_t get_pattern(char *cmd, char *pat)
+{
+   uint8_t len = 0;
+
+   if ((cmd = next_token(cmd)) == NULL)
+      return 0;
+
+   if (*cmd == '"')
+   {
+      for (cmd++; *cmd != '"' && !is_eos(*cmd) && len < MEM_PATTERN_MAX; cmd++, len++)
+         pat[len] = *cmd;
+      return len;
+   }
+
+   for (; cmd != NULL && len < MEM_PATTERN_MAX; cmd = next_token(cmd), len++)
+      pat[len] = asctoi(cmd);
+
+   return len;
+}
+
+
+/*! find <addr> <len> <byte> [<byte> ...] | find <addr> <len> "<string>"
+ * Outputs the address of every match.
+ */
+void cmd_find(int8_t argc, int *argv, char *cmd)
+{
+   char pat[MEM_PATTERN_MAX];
+   int addr, len, off;
+   int8_t type, err, cnt;
+   uint8_t plen;
+
+   if ((err = get_mem_param(&cmd, &addr, &type)) || (err = get_int_param(&cmd, &len)))
+   {
+      output_error(err);
+      return;
+   }
+
+   if (len < 1)
+   {
+      output_error(E_INVAL);
+      return;
+   }
+
+   if (!(plen = get_pattern(cmd, pat)))
+   {
+      output_error(E_NOPARM);
+      return;
+   }
+
+   for (cnt = 0; (off = mem_find((void*) addr, type, len, pat, plen)) != -1; cnt++)
+   {
+      if (cnt >= MEM_RESULTS_MAX)
+      {
+         print_more();
+         break;
+      }
+
+      write_ptr((void*) (addr + off));
+      println();
+
+      addr += off + 1;
+      len -= off + 1;
+   }
+}
+
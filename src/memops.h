@@ -0,0 +1,44 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MEMOPS_H
+#define MEMOPS_H
+
+// memory types
+#define MEM_RAM 0
+#define MEM_PRG 1
+#define MEM_EEP 3
+
+// maximum length of search pattern
+#define MEM_PATTERN_MAX 16
+// maximum number of results output by cmp and find
+#define MEM_RESULTS_MAX 16
+
+#ifndef __ASSEMBLER__
+
+#include <stdint.h>
+
+int mem_cmp(const void *a, int8_t ta, const void *b, int8_t tb, int len);
+int mem_find(const void *addr, int8_t type, int len, const char *pat, uint8_t plen);
+void mem_fill(void *addr, int8_t type, int len, int8_t val);
+void mem_copy(void *dst, int8_t dtype, const void *src, int8_t stype, int len);
+int8_t get_mem_param(char **cmd, int *addr, int8_t *type);
+
+#endif
+
+#endif
+
@@ -0,0 +1,179 @@
+# Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+#
+# This file is part of AVRshell.
+#
+# AVRshell is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, version 3 of the License.
+#
+# Generate the command dispatch table cmdtab.h from commands.def.
+#
+# The command names are hashed with h = h * MUL + c (mod 256) starting at SEED.
+# The perfect hash has two levels: the lower 3 bits of h select one of 8
+# buckets, the slot is (h >> 3) + DISP[bucket] (mod SIZE). The script searches
+# a MUL/SEED pair with distinct values of h for which displacements DISP can be
+# found, such that no slots collide, starting with the smallest table size
+# (power of 2). The generator fails if the table would exceed HASH_MAX slots.
+# The same hash function is implemented in cmd_hash() in parser.c.
+#
+# @usage awk -f mkcmdtab.awk commands.def > cmdtab.h
+
+function hash(s, seed, mul,   h, i)
+{
+   h = seed;
+   for (i = 1; i <= length(s); i++)
+      h = (h * mul + ord[substr(s, i, 1)]) % 256;
+   return h;
+}
+
+# place the buckets, the largest first, at the first displacement which does
+# not collide with the slots used so far
+function try(size, seed, mul,   i, b, d, k, h, hv, cnt, used, ok)
+{
+   for (b = 0; b < BUCKETS; b++)
+      cnt[b] = 0;
+   for (i = 0; i < n; i++)
+   {
+      h = hash(name[i], seed, mul);
+      if (h in hv)
+         return 0;
+      hv[h] = i;
+      bucket[i] = h % BUCKETS;
+      hi[i] = int(h / BUCKETS);
+      cnt[bucket[i]]++;
+   }
+
+   for (k = n; k > 0; k--)
+      for (b = 0; b < BUCKETS; b++)
+      {
+         if (cnt[b] != k)
+            continue;
+         for (d = 0; d < size; d++)
+         {
+            ok = 1;
+            for (i = 0; i < n && ok; i++)
+               if (bucket[i] == b && ((hi[i] + d) % size) in used)
+                  ok = 0;
+            if (ok)
+               break;
+         }
+         if (!ok)
+            return 0;
+         disp[b] = d;
+         for (i = 0; i < n; i++)
+            if (bucket[i] == b)
+            {
+               slot[i] = (hi[i] + d) % size;
+               used[slot[i]] = i;
+            }
+      }
+   return 1;
+}
+
+BEGIN {
+   # number of buckets (2^SHIFT) and maximum table size
+   BUCKETS = 8;
+   SHIFT = 3;
+   HASH_MAX = 128;
+   for (i = 32; i < 127; i++)
+      ord[sprintf("%c", i)] = i;
+   n = 0;
+}
+
+/^[ \t]*(#|$)/ {
+   next;
+}
+
+NF < 4 {
+   printf("%s:%d: syntax error\n", FILENAME, FNR) > "/dev/stderr";
+   err = 1;
+   exit 1;
+}
+
+{
+   for (i = 0; i < n; i++)
+      if (name[i] == $1)
+      {
+         printf("%s:%d: duplicate command \"%s\"\n", FILENAME, FNR, $1) > "/dev/stderr";
+         err = 1;
+         exit 1;
+      }
+   name[n] = $1;
+   func[n] = $2;
+   amin[n] = $3;
+   amax[n] = $4;
+   n++;
+}
+
+END {
+   if (err)
+      exit 1;
+
+   # the values h >> SHIFT of a bucket must not wrap around
+   for (size = 256 / BUCKETS; size < n; size *= 2);
+   found = 0;
+   for (; size <= HASH_MAX && !found; size *= 2)
+      for (mul = 1; mul < 256 && !found; mul += 2)
+         for (seed = 0; seed < 256 && !found; seed++)
+            if (try(size, seed, mul))
+               found = 1;
+
+   if (!found)
+   {
+      printf("no perfect hash with at most %d slots found\n", HASH_MAX) > "/dev/stderr";
+      exit 1;
+   }
+   # loops incremented once more after success
+   size /= 2;
+   mul -= 2;
+   seed--;
+
+   print "/* This file is generated by mkcmdtab.awk from commands.def. Do not edit! */";
+   print "";
+   print "#ifndef CMDTAB_H";
+   print "#define CMDTAB_H";
+   print "";
+   printf("#define CMD_HASH_SEED %d\n", seed);
+   printf("#define CMD_HASH_MUL %d\n", mul);
+   printf("#define CMD_HASH_SIZE %d\n", size);
+   printf("#define CMD_HASH_BUCKETS %d\n", BUCKETS);
+   printf("#define CMD_HASH_SHIFT %d\n", SHIFT);
+   print "";
+   for (i = 0; i < n; i++)
+      printf("void %s(int8_t, int*, char*);\n", func[i]);
+   print "";
+   for (i = 0; i < n; i++)
+      printf("static const char c_%s_[] PROGMEM = \"%s\";\n", name[i], name[i]);
+   print "";
+   print "static const struct cmd_entry cmd_tab_[] PROGMEM =";
+   print "{";
+   for (i = 0; i < n; i++)
+      printf("   {c_%s_, %s, CMD_ARGS(%d, %d)},\n", name[i], func[i], amin[i], amax[i]);
+   print "};";
+   print "";
+   for (i = 0; i < size; i++)
+      idx[i] = 255;
+   for (i = 0; i < n; i++)
+      idx[slot[i]] = i;
+   print "static const uint8_t cmd_disp_[CMD_HASH_BUCKETS] PROGMEM =";
+   print "{";
+   line = "  ";
+   for (b = 0; b < BUCKETS; b++)
+      line = line sprintf(" %3d,", disp[b]);
+   print line;
+   print "};";
+   print "";
+   print "static const uint8_t cmd_hash_[CMD_HASH_SIZE] PROGMEM =";
+   print "{";
+   for (i = 0; i < size; i += 8)
+   {
+      line = "  ";
+      for (j = i; j < i + 8 && j < size; j++)
+         line = line sprintf(" %3d,", idx[j]);
+      print line;
+   }
+   print "};";
+   print "";
+   print "#endif";
+   print "";
+}
@@ -20,29 +20,7 @@
 #include "avrshell.h"
 #include "parser.h"
 #include "progmem.h"
-
-
-static const char c_in_[] PROGMEM = "in";
-static const char c_out_[] PROGMEM = "out";
-static const char c_dump_[] PROGMEM = "dump";
-static const char c_pdump_[] PROGMEM = "pdump";
-static const char c_sbi_[] PROGMEM = "sbi";
-static const char c_cbi_[] PROGMEM = "cbi";
-static const char c_lds_[] PROGMEM = "lds";
-static const char c_sts_[] PROGMEM = "sts";
-static const char c_help_[] PROGMEM = "help";
-static const char c_edump_[] PROGMEM = "edump";
-static const char c_ste_[] PROGMEM = "ste";
-static const char c_cpu_[] PROGMEM = "cpu";
-static const char c_uptime_[] PROGMEM = "uptime";
-static const char c_run_[] PROGMEM = "run";
-static const char c_stop_[] PROGMEM = "stop";
-static const char c_new_[] PROGMEM = "new";
-static const char c_ps_[] PROGMEM = "ps";
-
-static const char * const cmd_[] __attribute__((__progmem__)) = {c_in_, c_out_,
-   c_dump_, c_pdump_, c_sbi_, c_cbi_, c_lds_, c_sts_, c_help_, c_edump_,
-   c_ste_, c_cpu_, c_uptime_, c_run_, c_stop_, c_new_, c_ps_};
+#include "cmdtab.h"
 
 
 int strlen(const char *s)
@@ -234,23 +212,41 @@ int8_t get_int_param(char **cmd, int *parm)
 }
 
 
-int8_t get_command(const char *cmd, uint8_t rlen)
+/*! Calculate the slot of a command name in cmd_hash_[]. The lower bits of
+ * the hash select the displacement of the bucket which is added to the upper
+ * bits. This must be the same function as in mkcmdtab.awk.
+ */
+static uint8_t cmd_hash(const char *s, uint8_t len)
 {
-	char **ps, *s;
-	uint8_t i, slen;
-
-	ps = (char**) &cmd_;
-	for (i = 0; i < sizeof(cmd_)/sizeof(*cmd_); i++)
-	{
-		// get address from prg memory
-		s = pgm_ptr(ps);
-		ps++;
-
-		slen = pstrlen(s);
-		if ((rlen >= slen) && !pstrncmp(cmd, s, slen))
-         return i;
-   }
+   uint8_t h = CMD_HASH_SEED;
 
-   return -1;
+   for (; len; len--, s++)
+      h = h * CMD_HASH_MUL + *s;
+
+   return ((h >> CMD_HASH_SHIFT) + pgm_byte(&cmd_disp_[h & (CMD_HASH_BUCKETS - 1)])) & (CMD_HASH_SIZE - 1);
 }
 
+
+/*! Find command in command table.
+ * @param cmd Pointer to command string. The command is terminated by a space,
+ * a ';', or the end of the string.
+ * @return Returns a pointer to the command entry in program memory or NULL if
+ * the command does not exist.
+ */
+const struct cmd_entry *get_command(const char *cmd)
+{
+   const struct cmd_entry *ce;
+   uint8_t len;
+   int8_t i;
+
+   for (len = 0; cmd[len] != ' ' && cmd[len] != ';' && !is_eos(cmd[len]); len++);
+
+   if ((i = pgm_byte(&cmd_hash_[cmd_hash(cmd, len)])) < 0)
+      return NULL;
+
+   ce = &cmd_tab_[i];
+   if (pstrlen(pgm_ptr(&ce->name)) != len || pstrncmp(cmd, pgm_ptr(&ce->name), len))
+      return NULL;
+
+   return ce;
+}
@@ -25,6 +25,15 @@
 #define E_NOPARM -2
 #define E_CONVERR -3
 #define E_TRUNC -4
+#define E_INVAL -5
+#define E_NOMEM -6
+#define E_TIMEOUT -7
+#define E_VERIFY -8
+#define E_NACK -9
+#define E_BUS -10
+#define E_BUSY -11
+
+#ifndef __ASSEMBLER__
 
 char nibble_to_ascx(char a);
 int8_t is_eos(char a);
@@ -32,14 +41,36 @@ int8_t is_xdigit(char a);
 int8_t asc_to_nibble(int8_t a);
 int asctoi(const char *s);
 char *next_token(char *s);
+// maximum number of integer arguments parsed by the command dispatcher
+#define CMD_MAXARGS 6
+// handler parses its arguments itself
+#define CMD_RAW 0xf
+// like CMD_RAW but the handler receives the rest of the line including ';'
+#define CMD_LINE 0xe
+#define CMD_ARGS(min, max) ((min) | (max) << 4)
+#define CMD_ARGS_MIN(x) ((x) & 0xf)
+#define CMD_ARGS_MAX(x) (((x) >> 4) & 0xf)
+
+/*! Command handler. It receives the number of integer arguments argc which
+ * have been parsed into argv and a pointer to the last token which was parsed
+ * (the command itself if argc is 0).
+ */
+typedef void (*cmd_func_t)(int8_t argc, int *argv, char *cmd);
+
+/*! Entry of the command table in program memory (see commands.def). */
+struct cmd_entry
+{
+   const char *name;
+   cmd_func_t func;
+   uint8_t args;
+};
+
 int8_t get_int_param(char **cmd, int *parm);
-int8_t get_command(const char *cmd, uint8_t rlen);
+const struct cmd_entry *get_command(const char *cmd);
 int8_t lint_to_str(long int n, char *buf, int len);
 int strlen(const char *s);
 
-
-enum {C_IN, C_OUT, C_DUMP, C_PDUMP, C_SBI, C_CBI, C_LDS, C_STS, C_HELP,
-   C_EDUMP, C_STE, C_CPU, C_UPTIME, C_RUN, C_STOP, C_NEW, C_PS};
+#endif
 
 #endif
 
@@ -0,0 +1,107 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file pin.c
+ * This file contains the waiting for pin change events and the command
+ * pinwait.
+ *
+ * @author Bernhard R. Fischer, 4096R/8E24F29D bf@abenteuerland.at
+ */
+
+#include "avrshell.h"
+#include "parser.h"
+#include "process.h"
+#include "serial_io.h"
+#include "timer.h"
+#include "pin.h"
+
+
+static void pin_wake(void *pid)
+{
+   run_proc((int) pid);
+}
+
+
+/*! Wait for a change of pins. The process does not consume CPU time while it
+ * waits. The pins have to be watched with pin_watch(), changes which occurred
+ * since then are returned immediately.
+ * @param group Pin change interrupt (0-2).
+ * @param mask Pins.
+ * @param ev Pointer to event which receives the change.
+ * @param timeout Timeout in ticks, 0 waits forever.
+ * @return E_OK or E_TIMEOUT.
+ */
+int8_t pin_wait(uint8_t group, uint8_t mask, struct pin_event *ev, uint16_t timeout)
+{
+   struct timer tm;
+   int8_t err;
+
+   if (!timeout)
+      return pin_get(group, mask, ev, NULL) ? E_OK : E_TIMEOUT;
+
+   timer_init(&tm, pin_wake, (void*) (int) get_pid());
+   timer_start(&tm, timeout, 0);
+   err = pin_get(group, mask, ev, &tm) ? E_OK : E_TIMEOUT;
+   timer_stop(&tm);
+
+   return err;
+}
+
+
+/*! pinwait <port> <mask> [<n> [<timeout>]]
+ * Watch the pins <mask> of pin change interrupt <port> and output <n> changes
+ * (default 1) as "<time> <pins> <changed>". The time is in timer 0 counts
+ * (64us) as 32 bit hex value. <timeout> is in ticks per change, 0 (default)
+ * waits forever.
+ */
+void cmd_pinwait(int8_t argc, int *argv, char *cmd)
+{
+   struct pin_event ev;
+   uint16_t timeout;
+   uint8_t group, mask;
+   int8_t err;
+   int n;
+
+   group = argv[0];
+   mask = argv[1];
+   n = argc > 2 ? argv[2] : 1;
+   timeout = argc > 3 ? argv[3] : 0;
+
+   if (argv[0] < 0 || argv[0] >= PIN_GROUPS || !mask || n < 1)
+   {
+      output_error(E_INVAL);
+      return;
+   }
+
+   pin_watch(group, mask);
+   for (; n && !(err = pin_wait(group, mask, &ev, timeout)); n--)
+   {
+      write_hexbyte(ev.time >> 24);
+      write_hexbyte(ev.time >> 16);
+      write_hexbyte(ev.time >> 8);
+      write_hexbyte(ev.time);
+      sys_send(' ');
+      write_hexbyte(ev.pins);
+      sys_send(' ');
+      write_hexbyte(ev.changed);
+      println();
+   }
+   pin_unwatch(group, mask);
+
+   output_error(err);
+}
+
@@ -0,0 +1,60 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PIN_H
+#define PIN_H
+
+// number of pin change interrupts (groups of 8 pins)
+#define PIN_GROUPS 3
+// number of events in the queue
+#define PIN_QUEUE_SIZE 8
+
+// offsets in struct pin_event
+#define PIN_EV_GROUP_OFF 0
+#define PIN_EV_PINS_OFF 1
+#define PIN_EV_CHANGED_OFF 2
+#define PIN_EV_TIME_OFF 3
+#define PIN_EV_SIZE 7
+
+#ifndef __ASSEMBLER__
+
+#include <stdint.h>
+#include "timer.h"
+
+/*! Pin change event. The time is in timer 0 counts (64us at 16MHz) since
+ * startup. Rising edges are changed & pins, falling edges changed & ~pins.
+ */
+struct pin_event
+{
+   uint8_t group;             // pin change interrupt 0-2
+   uint8_t pins;              // state of the pins after the change
+   uint8_t changed;           // watched pins which changed
+   uint32_t time;             // timer 0 counts
+};
+
+// number of events discarded because the queue was full
+extern uint16_t pin_lost;
+
+void pin_watch(uint8_t, uint8_t);
+void pin_unwatch(uint8_t, uint8_t);
+int8_t pin_get(uint8_t, uint8_t, struct pin_event *, struct timer *);
+int8_t pin_wait(uint8_t, uint8_t, struct pin_event *, uint16_t);
+
+#endif
+
+#endif
+
@@ -0,0 +1,109 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file pool.c
+ * This file contains the command mem which shows the usage of the memory
+ * pool.
+ *
+ * @author Bernhard R. Fischer, 4096R/8E24F29D bf@abenteuerland.at
+ */
+
+#include "avrshell.h"
+#include "parser.h"
+#include "progmem.h"
+#include "serial_io.h"
+#include "pool.h"
+
+
+static const char s_mem_hdr_[] PROGMEM = "size used/blks bytes";
+static const char s_free_[] PROGMEM = "free ";
+static const char s_largest_[] PROGMEM = ", largest ";
+static const char s_waste_[] PROGMEM = ", waste ";
+static const char s_fail_[] PROGMEM = "%, failed ";
+
+
+static void write_int(int i)
+{
+   char s[8];
+
+   lint_to_str(i, s, sizeof(s));
+   sys_write(s, strlen(s));
+}
+
+
+/*! mem
+ * Output for each size class the block size, the number of used and total
+ * blocks, and the number of bytes requested by the users of the blocks.
+ * Finally the free memory, the largest free block, the internal fragmentation
+ * (percentage of the used blocks which is not requested), and the number of
+ * failed allocations is output.
+ */
+void cmd_mem(int8_t argc, int *argv, char *cmd)
+{
+   const struct pool_class *pc;
+   unsigned size, cnt, first, used, bytes, nfree, largest;
+   unsigned long ublk, ubytes;
+   uint8_t i, j, map;
+
+   sys_pwrite(s_mem_hdr_, sizeof(s_mem_hdr_) - 1);
+   println();
+
+   nfree = largest = 0;
+   ublk = ubytes = 0;
+   for (i = 0, pc = pool_cls; i < POOL_CLASSES; i++, pc++)
+   {
+      size = pgm_word(&pc->size);
+      cnt = pgm_byte(&pc->cnt);
+      first = pgm_byte(&pc->first);
+      map = pool_map[i];
+
+      for (j = 0, used = 0, bytes = 0; j < cnt; j++)
+         if (map & (1 << j))
+         {
+            used++;
+            bytes += pool_len[first + j] + 1;
+         }
+
+      if (used < cnt)
+      {
+         nfree += (cnt - used) * size;
+         largest = size;
+      }
+      ublk += (unsigned long) used * size;
+      ubytes += bytes;
+
+      write_int(size);
+      sys_send(' ');
+      write_int(used);
+      sys_send('/');
+      write_int(cnt);
+      sys_send(' ');
+      write_int(bytes);
+      println();
+   }
+
+   sys_pwrite(s_free_, sizeof(s_free_) - 1);
+   write_int(nfree);
+   sys_pwrite(s_largest_, sizeof(s_largest_) - 1);
+   write_int(largest);
+   sys_pwrite(s_waste_, sizeof(s_waste_) - 1);
+   write_int(ublk ? (ublk - ubytes) * 100 / ublk : 0);
+   sys_pwrite(s_fail_, sizeof(s_fail_) - 1);
+   write_int(pool_fail);
+   println();
+}
+
@@ -0,0 +1,90 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#include "mcu.h"
+
+// Size classes of the memory pool. The block size of every class is given in
+// bytes (max. 256), the number of blocks per class is at most 8 (one bitmap
+// byte). The classes have to be in ascending order of their block size. There
+// are up to 5 classes.
+#if defined(__AVR_ATmega2560__)
+#define POOL_CLASSES 5
+#define POOL_SIZE_0 16
+#define POOL_CNT_0 8
+#define POOL_SIZE_1 64
+#define POOL_CNT_1 8
+#define POOL_SIZE_2 128
+#define POOL_CNT_2 4
+// two classes of stacks for up to 16 processes
+#define POOL_SIZE_3 256
+#define POOL_CNT_3 8
+#define POOL_SIZE_4 256
+#define POOL_CNT_4 8
+#else
+#define POOL_CLASSES 4
+#define POOL_SIZE_0 16
+#define POOL_CNT_0 8
+#define POOL_SIZE_1 64
+#define POOL_CNT_1 4
+#define POOL_SIZE_2 128
+#define POOL_CNT_2 5
+#define POOL_SIZE_3 256
+#define POOL_CNT_3 1
+#define POOL_SIZE_4 0
+#define POOL_CNT_4 0
+#endif
+
+#define POOL_BLOCKS (POOL_CNT_0 + POOL_CNT_1 + POOL_CNT_2 + POOL_CNT_3 + POOL_CNT_4)
+#define POOL_BYTES (POOL_SIZE_0 * POOL_CNT_0 + POOL_SIZE_1 * POOL_CNT_1 + POOL_SIZE_2 * POOL_CNT_2 + POOL_SIZE_3 * POOL_CNT_3 + POOL_SIZE_4 * POOL_CNT_4)
+
+// size of class descriptor in pool_cls
+#define POOL_CLS_ENTRY 8
+
+#ifndef __ASSEMBLER__
+
+#include <stdint.h>
+
+// class descriptor, the table pool_cls is located in the program memory
+struct pool_class
+{
+   uint16_t size;    // block size
+   uint8_t cnt;      // number of blocks
+   uint8_t first;    // index of first block in pool_len
+   uint16_t off;     // offset of first block in pool_arena
+   uint16_t end;     // offset following the last block
+};
+
+extern const struct pool_class pool_cls[POOL_CLASSES];
+// bitmap of used blocks for each class
+extern uint8_t pool_map[POOL_CLASSES];
+// requested size - 1 of every used block
+extern uint8_t pool_len[POOL_BLOCKS];
+// number of failed allocations
+extern uint8_t pool_fail;
+// memory of all blocks
+extern char pool_arena[POOL_BYTES];
+
+void *pool_alloc(uint16_t);
+void pool_free(void *);
+
+#endif
+
+#endif
+
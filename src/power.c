@@ -0,0 +1,101 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file power.c
+ * This file contains the command power which shows the sleep statistics and
+ * controls the power management.
+ *
+ * @author Bernhard R. Fischer, 4096R/8E24F29D bf@abenteuerland.at
+ */
+
+#include "avrshell.h"
+#include "parser.h"
+#include "progmem.h"
+#include "serial_io.h"
+#include "timer.h"
+#include "power.h"
+
+
+static const char s_power_hdr_[] PROGMEM = "mode sleeps ticks";
+static const char s_modes_[] PROGMEM = "idle adc  save ";
+static const char s_asleep_[] PROGMEM = "asleep ";
+static const char s_deep_[] PROGMEM = "%, deep ";
+static const char s_prr_[] PROGMEM = ", prr 0x";
+
+
+static void write_long(long l)
+{
+   char s[12];
+
+   lint_to_str(l, s, sizeof(s));
+   sys_write(s, strlen(s));
+}
+
+
+/*! power [<deep> [<modules>]]
+ * Without arguments the number of sleeps and the time asleep (in ticks) of
+ * each sleep mode is output, followed by the percentage of the uptime asleep,
+ * the power-save setting, and the modules which are switched off (PRR0 and
+ * PRR1 as 16 bit value). <deep> = 1 allows ADC noise reduction and power-save
+ * mode. <modules> sets the modules which are switched off.
+ */
+void cmd_power(int8_t argc, int *argv, char *cmd)
+{
+   // power_cnt followed by power_time
+   uint32_t stat[2 * PWR_MODES];
+   unsigned long asleep, up;
+   uint8_t i;
+
+   if (argc)
+   {
+      power_deep = argv[0] != 0;
+      if (argc > 1)
+      {
+         sys_power_on(~argv[1]);
+         sys_power_off(argv[1]);
+      }
+      return;
+   }
+
+   power_copy(stat);
+   up = get_uptime();
+
+   sys_pwrite(s_power_hdr_, sizeof(s_power_hdr_) - 1);
+   println();
+
+   for (i = 0, asleep = 0; i < PWR_MODES; i++)
+   {
+      sys_pwrite(s_modes_ + i * 5, 5);
+      write_long(stat[i]);
+      sys_send(' ');
+      write_long(stat[PWR_MODES + i] >> 8);
+      println();
+      asleep += stat[PWR_MODES + i] >> 8;
+   }
+
+   sys_pwrite(s_asleep_, sizeof(s_asleep_) - 1);
+   write_long(up >= 100 ? asleep / (up / 100) : 0);
+   sys_pwrite(s_deep_, sizeof(s_deep_) - 1);
+   write_long(power_deep);
+   sys_pwrite(s_prr_, sizeof(s_prr_) - 1);
+#ifdef PRR1
+   write_hexbyte(PRR1);
+#endif
+   write_hexbyte(PRR0);
+   println();
+}
+
@@ -0,0 +1,87 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <avr/io.h>
+
+#include "mcu.h"
+
+// the 1st power reduction register is named PRR on MCUs which have only one
+#ifndef PRR0
+#define PRR0 PRR
+#endif
+
+// modules for sys_power_on() and sys_power_off(), the low byte contains the
+// bits of PRR0, the high byte those of PRR1
+#define PWR_ADC _BV(PRADC)
+#define PWR_USART0 _BV(PRUSART0)
+#define PWR_SPI _BV(PRSPI)
+#define PWR_TIM1 _BV(PRTIM1)
+#define PWR_TIM2 _BV(PRTIM2)
+#define PWR_TWI _BV(PRTWI)
+#ifdef PRR1
+#define PWR_USART1 (_BV(PRUSART1) << 8)
+#define PWR_USART2 (_BV(PRUSART2) << 8)
+#define PWR_USART3 (_BV(PRUSART3) << 8)
+#define PWR_TIM3 (_BV(PRTIM3) << 8)
+#define PWR_TIM4 (_BV(PRTIM4) << 8)
+#define PWR_TIM5 (_BV(PRTIM5) << 8)
+#define PWR_PRR1 (PWR_USART1 | PWR_USART2 | PWR_USART3 | PWR_TIM3 | PWR_TIM4 | PWR_TIM5)
+#else
+#define PWR_PRR1 0
+#endif
+
+// modules which are switched off at startup, all except timer 0 and USART0
+#define PWR_INIT_OFF (PWR_ADC | PWR_SPI | PWR_TIM1 | PWR_TIM2 | PWR_TWI | PWR_PRR1)
+// modules which have to be off for power-save mode, timer 2 may run
+// asynchronously
+#define PWR_SAVE_OFF (PWR_ADC | PWR_SPI | PWR_TIM1 | PWR_TWI | PWR_PRR1)
+
+// sleep modes, index of power_cnt and power_time
+#define PWR_IDLE 0
+#define PWR_ADCNR 1
+#define PWR_SAVE 2
+#define PWR_MODES 3
+
+// ticks after a received byte before ADC noise reduction or power-save mode
+// is used (about 1s)
+#define PWR_RX_HOLD 61
+
+// size of the counters in power_cnt and power_time
+#define PWR_CNT_SIZE 4
+
+#ifndef __ASSEMBLER__
+
+#include <stdint.h>
+
+// number of times the CPU went to sleep in each mode
+extern uint32_t power_cnt[PWR_MODES];
+// time asleep in each mode in timer 0 counts (256 counts are 1 tick)
+extern uint32_t power_time[PWR_MODES];
+// ADC noise reduction and power-save mode are allowed if set to 1
+extern uint8_t power_deep;
+
+void sys_power_on(uint16_t);
+void sys_power_off(uint16_t);
+void power_copy(uint32_t *);
+
+#endif
+
+#endif
+
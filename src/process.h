@@ -22,28 +22,55 @@
 #include <stdint.h>
 #endif
 
-// maximum number of processes
-#define MAX_PROCS 5
+// MAX_PROCS and STACK_SIZE (process stacks are allocated from the memory pool)
+// depend on the MCU
+#include "mcu.h"
+
 // number of bytes used per process in the process list
-#define PROC_LIST_ENTRY 4
-// process stack size
-#define STACK_SIZE 128
+#define PROC_LIST_ENTRY 9
 // process states
 #define PSTATE_UNUSED 0
 #define PSTATE_RUN 1
 #define PSTATE_WAIT 2
+// not used anymore, exit_proc() frees the slot of an exiting process
 #define PSTATE_ZOMBIE 3
 #define PSTATE_NEW 4
-#define PSTATE_STOP 5
 #define PSTATE_IDLE 7
+// flag of a stopped process, it keeps its state (e.g. PSTATE_WAIT) but it is
+// not scheduled until it is continued
+#define PSTATE_STOPPED 0x40
 // offset of pstate in process list struct
 #define PSTRUCT_STATE_OFF 2
 #define PSTRUCT_EVENT_OFF 3
+#define PSTRUCT_STACK_OFF 4
+#define PSTRUCT_DATA_OFF 6
+#define PSTRUCT_TTY_OFF 8
+
+// context frame of a process which is not running, offsets relative to its
+// saved stack pointer: EIND and RAMPZ (CTX_XREGS), SREG, r31 down to r0, and
+// the return address (high byte first)
+#define CTX_SREG_OFF (1 + CTX_XREGS)
+#define CTX_REGS_OFF (CTX_SREG_OFF + 1)
+#define CTX_PC_OFF (CTX_REGS_OFF + 32)
+// stack pointer of the process after the context was restored
+#define CTX_SIZE (CTX_PC_OFF + PC_SIZE - 1)
 
 #define NEXT_PROC_UNAVAIL 0xff
 #define NEXT_PROC_SAME 0xfe
 
-#define SYS_SEM_READ 0
+#define SYS_SEM_EEPROM 0
+// input semaphores of the ttys, SYS_SEM_TTY + number of tty
+#define SYS_SEM_TTY 1
+
+// semaphore of the TWI and SPI drivers, they are used by one process at a time
+#define SYS_SEM_BUS (SYS_SEM_TTY + NUM_TTYS)
+
+#if SYS_SEM_BUS >= 8
+#error "too many ttys"
+#endif
+
+// event of a waiting process which is not waiting for a semaphore
+#define PEVENT_NONE 0xff
 
 #ifndef __ASSEMBLER__
 
@@ -56,15 +83,25 @@ struct plist_entry
    char *sp;
    int8_t pstate;
    int8_t event;
+   char *stack;      // stack memory block
+   void *data;       // memory block of process, freed at exit
+   uint8_t tty;      // tty of process, inherited by new processes
 };
 
 pid_t start_proc(void (*)(void));
 pid_t new_proc(void (*)(void));
 void run_proc(pid_t);
 void stop_proc(pid_t);
+void cont_proc(pid_t);
+void kill_proc(pid_t);
+pid_t get_pid(void);
+uint8_t get_tty(void);
 void sys_schedule();
 void sys_set_event(uint8_t);
+void sys_sem_wait(uint8_t);
+void sys_sem_post(uint8_t);
 struct plist_entry *get_proc_list(void);
+char *proc_context(pid_t, char *);
 
 #endif
 
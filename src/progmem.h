@@ -19,6 +19,11 @@
 #define PROGMEM_H
 
 
+// number of entries of the EEPROM write queue
+#define EE_QUEUE_SIZE 16
+
+#ifndef __ASSEMBLER__
+
 #include <stdint.h>
 
 
@@ -31,9 +36,12 @@ int8_t pgm_byte(const void*);
 
 int8_t read_eeprom(const void*);
 void write_eeprom(const void*, int8_t);
+void ee_sync(void);
 
 int8_t read_fuse(int addr);
 int8_t read_sig(int addr);
 
 #endif
 
+#endif
+
@@ -0,0 +1,274 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file script.c
+ * This file contains the macros which are stored in the EEPROM. A macro is a
+ * named command line which may contain several commands separated by ';'.
+ * The macro "autorun" is executed at startup before the first prompt.
+ *
+ * The macros are stored as a list of records. The first byte of each record
+ * is the length of the record (including the length byte), followed by the
+ * \0-terminated name and the \0-terminated command line. A deleted record has
+ * an empty name. The list is terminated by SCRIPT_END.
+ *
+ * @author Bernhard R. Fischer, 4096R/8E24F29D bf@abenteuerland.at
+ */
+
+#include "avrshell.h"
+#include "parser.h"
+#include "progmem.h"
+#include "serial_io.h"
+#include "pool.h"
+#include "process.h"
+#include "script.h"
+
+
+static const char s_autorun_[] PROGMEM = "autorun";
+
+// bit per process which is set while the process executes a macro, macros
+// cannot be nested
+static uint16_t running_;
+
+
+void init_script(void)
+{
+   running_ = 0;
+}
+
+
+static uint8_t tok_len(const char *s)
+{
+   uint8_t len;
+
+   for (len = 0; s[len] != ' ' && s[len] != ';' && !is_eos(s[len]); len++);
+   return len;
+}
+
+
+/*! Find macro in EEPROM.
+ * @param name Name of the macro, terminated by space, ';' or end of string.
+ * @param end If not NULL, the address of the end of the list is stored to it.
+ * @return Returns the EEPROM address of the macro record or -1 if it does not
+ * exist.
+ */
+static int script_find(const char *name, int *end)
+{
+   uint8_t len, nlen, i;
+   int addr;
+
+   nlen = tok_len(name);
+   for (addr = SCRIPT_EEP_START; addr < SCRIPT_EEP_START + SCRIPT_EEP_SIZE; addr += len)
+   {
+      if ((len = read_eeprom((void*) addr)) == SCRIPT_END || !len)
+         break;
+
+      for (i = 0; i < nlen && read_eeprom((void*) (addr + 1 + i)) == name[i]; i++);
+      if (i == nlen && nlen && !read_eeprom((void*) (addr + 1 + i)))
+         return addr;
+   }
+
+   if (end != NULL)
+      *end = addr;
+
+   return -1;
+}
+
+
+/*! Remove deleted records from the macro list.
+ * @return Returns the address of the end of the list.
+ */
+static int script_compact(void)
+{
+   int src, dst;
+   uint8_t len, i;
+
+   for (src = dst = SCRIPT_EEP_START; src < SCRIPT_EEP_START + SCRIPT_EEP_SIZE; src += len)
+   {
+      if ((len = read_eeprom((void*) src)) == SCRIPT_END || !len)
+         break;
+
+      // skip deleted records
+      if (!read_eeprom((void*) (src + 1)))
+         continue;
+
+      if (src != dst)
+         for (i = 0; i < len; i++)
+            write_eeprom((void*) (dst + i), read_eeprom((void*) (src + i)));
+      dst += len;
+   }
+
+   if (dst < SCRIPT_EEP_START + SCRIPT_EEP_SIZE)
+      write_eeprom((void*) dst, SCRIPT_END);
+
+   return dst;
+}
+
+
+/*! Execute a macro.
+ * @param name Name of the macro, terminated by space, ';' or end of string.
+ * @return Returns E_OK if the macro was executed, E_NOPARM if there is no
+ * such macro, or E_NOMEM if no line buffer is available.
+ */
+int8_t script_exec(const char *name)
+{
+   char *sbuf;
+   uint16_t bit;
+   uint8_t i;
+   int addr;
+
+   bit = 1U << get_pid();
+   if ((running_ & bit) || (addr = script_find(name, NULL)) == -1)
+      return E_NOPARM;
+
+   if ((sbuf = pool_alloc(SCRIPT_LINE_MAX)) == NULL)
+      return E_NOMEM;
+
+   // skip length byte and name
+   for (addr++; read_eeprom((void*) addr); addr++);
+   addr++;
+
+   for (i = 0; i < SCRIPT_LINE_MAX - 1 && (sbuf[i] = read_eeprom((void*) (addr + i))); i++);
+   sbuf[i] = '\0';
+
+   running_ |= bit;
+   exec_line(sbuf);
+   running_ &= ~bit;
+
+   pool_free(sbuf);
+
+   return E_OK;
+}
+
+
+/*! Execute the macro "autorun" if it exists. */
+void script_autorun(void)
+{
+   char name[sizeof(s_autorun_)];
+   uint8_t i;
+
+   for (i = 0; (name[i] = pgm_byte(&s_autorun_[i])); i++);
+   script_exec(name);
+}
+
+
+static void script_delete(int addr)
+{
+   if (addr != -1)
+      write_eeprom((void*) (addr + 1), 0);
+}
+
+
+/*! Define macro: def <name> <command line> */
+void cmd_def(int8_t argc, int *argv, char *cmd)
+{
+   char *name, *body;
+   uint8_t nlen, blen, i;
+   int end;
+
+   if ((name = next_token(cmd)) == NULL || (body = next_token(name)) == NULL)
+   {
+      output_error(E_NOPARM);
+      return;
+   }
+
+   nlen = tok_len(name);
+   if (name[nlen] == ';' || get_command(name) != NULL)
+   {
+      output_error(E_INVAL);
+      return;
+   }
+
+   blen = strlen(body);
+   // strip trailing newline
+   for (; blen && is_eos(body[blen - 1]); blen--);
+
+   if (nlen + blen + 3 > SCRIPT_LINE_MAX)
+   {
+      output_error(E_INVAL);
+      return;
+   }
+
+   script_delete(script_find(name, NULL));
+   script_find(name, &end);
+
+   if (end + nlen + blen + 3 > SCRIPT_EEP_START + SCRIPT_EEP_SIZE)
+      end = script_compact();
+   if (end + nlen + blen + 3 > SCRIPT_EEP_START + SCRIPT_EEP_SIZE)
+   {
+      output_error(E_NOMEM);
+      return;
+   }
+
+   write_eeprom((void*) end++, nlen + blen + 3);
+   for (i = 0; i < nlen; i++)
+      write_eeprom((void*) end++, name[i]);
+   write_eeprom((void*) end++, 0);
+   for (i = 0; i < blen; i++)
+      write_eeprom((void*) end++, body[i]);
+   write_eeprom((void*) end++, 0);
+
+   if (end < SCRIPT_EEP_START + SCRIPT_EEP_SIZE)
+      write_eeprom((void*) end, SCRIPT_END);
+}
+
+
+/*! Delete macro: undef <name> */
+void cmd_undef(int8_t argc, int *argv, char *cmd)
+{
+   int addr;
+
+   if ((cmd = next_token(cmd)) == NULL)
+   {
+      output_error(E_NOPARM);
+      return;
+   }
+
+   if ((addr = script_find(cmd, NULL)) == -1)
+   {
+      output_error(E_INVAL);
+      return;
+   }
+
+   script_delete(addr);
+}
+
+
+/*! List all macros. */
+void cmd_macros(int8_t argc, int *argv, char *cmd)
+{
+   uint8_t len;
+   int8_t c;
+   int addr, i;
+
+   for (addr = SCRIPT_EEP_START; addr < SCRIPT_EEP_START + SCRIPT_EEP_SIZE; addr += len)
+   {
+      if ((len = read_eeprom((void*) addr)) == SCRIPT_END || !len)
+         break;
+
+      if (!read_eeprom((void*) (addr + 1)))
+         continue;
+
+      for (i = addr + 1; (c = read_eeprom((void*) i)); i++)
+         sys_send(c);
+      sys_send(':');
+      sys_send(' ');
+      for (i++; (c = read_eeprom((void*) i)); i++)
+         sys_send(c);
+      println();
+   }
+}
+
@@ -0,0 +1,36 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCRIPT_H
+#define SCRIPT_H
+
+#include <stdint.h>
+
+// EEPROM area which is used to store the macros
+#define SCRIPT_EEP_START 0
+#define SCRIPT_EEP_SIZE 512
+// maximum length of a macro including its name
+#define SCRIPT_LINE_MAX 64
+// record marker of the end of the macro list (erased EEPROM)
+#define SCRIPT_END 0xff
+
+void init_script(void);
+int8_t script_exec(const char *name);
+void script_autorun(void);
+
+#endif
+
@@ -21,6 +21,25 @@
 
 #include <avr/io.h>
 
+// baud rate of the USARTs, has to match BAUDCOUNT in serial_io.S
+#define TTY_BAUD 9600
+
+// escape byte of the channel selection of virtual ttys
+#define TTY_DLE 0x10
+
+// tty modes, see sys_tty_mode()
+#define TTY_ECHO_BIT 0
+#define TTY_LEDIT_BIT 1
+#define TTY_RAW_BIT 2
+// echo received bytes
+#define TTY_ECHO _BV(TTY_ECHO_BIT)
+// line editing: backspace deletes, \r is translated to \n
+#define TTY_LEDIT _BV(TTY_LEDIT_BIT)
+// every byte is passed to the reader immediately, no XON/XOFF is sent
+#define TTY_RAW _BV(TTY_RAW_BIT)
+
+
+#ifndef __ASSEMBLER__
 
 void init_serial();
 void sys_read_flush();
@@ -29,6 +48,11 @@ uint8_t sys_write(const char *, uint8_t);
 uint8_t sys_pwrite(const char *, uint8_t);
 void sys_send(char);
 uint8_t sys_peek_serial(void);
+void sys_rx_inject(const char *, uint8_t);
+int8_t sys_tty_open(uint8_t);
+uint8_t sys_tty_mode(int8_t);
+
+#endif
 
 
 #endif
@@ -15,16 +15,60 @@
  * along with smrender. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "avrshell.h"
 #include "process.h"
 #include "timer.h"
 
 
+/*! Initialize timer with callback function. The function is called within
+ * the timer interrupt on the stack of the interrupted process with interrupts
+ * disabled, thus it has to be short and must not wait, e.g. run_proc().
+ * @param t Pointer to timer.
+ * @param func Callback function.
+ * @param arg Argument which is passed to func.
+ */
+void timer_init(struct timer *t, void (*func)(void *), void *arg)
+{
+   t->state = TIMER_IDLE;
+   t->func = func;
+   t->arg = arg;
+   t->sem = 0;
+}
+
+
+/*! Initialize timer which posts a semaphore.
+ * @param t Pointer to timer.
+ * @param sem Number of semaphore.
+ */
+void timer_init_sem(struct timer *t, uint8_t sem)
+{
+   timer_init(t, NULL, NULL);
+   t->sem = sem;
+}
+
+
+static void tsleep_wake(void *pid)
+{
+   run_proc((int) pid);
+}
+
+
+/*! Sleep for t ticks. The process waits, thus it does not consume any CPU
+ * time.
+ */
 void tsleep(unsigned long t)
 {
-   t += get_uptime();
-   while (t > get_uptime())
+   struct timer tm;
+   uint16_t n;
+
+   timer_init(&tm, tsleep_wake, (void*) (int) get_pid());
+   for (; t; t -= n)
    {
-      sys_schedule();
+      n = t > 0xffff ? 0xffff : t;
+      timer_wait(&tm, n);
+      // the process may have been run before the timer expired
+      timer_wait_idle(&tm);
    }
+   timer_stop(&tm);
 }
 
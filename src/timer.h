@@ -18,8 +18,54 @@
 #ifndef TIMER_H
 #define TIMER_H
 
+// offsets in struct timer
+#define TIMER_NEXT_OFF 0
+#define TIMER_DELTA_OFF 2
+#define TIMER_STATE_OFF 4
+#define TIMER_OWNER_OFF 5
+#define TIMER_PERIOD_OFF 6
+#define TIMER_FUNC_OFF 8
+#define TIMER_ARG_OFF 10
+#define TIMER_SEM_OFF 12
+
+// timer states
+#define TIMER_IDLE 0
+#define TIMER_PENDING 1
+
+#ifndef __ASSEMBLER__
+
+#include <stdint.h>
+
+/*! Software timer. The pending timers are kept in a list sorted by their
+ * expiry. Each timer stores its ticks relative to the previous one (delta),
+ * thus the tick interrupt only decreases the 1st one. Expired timers are
+ * handled within the tick interrupt which calls the callback function or posts
+ * the semaphore if there is no callback function. The struct is provided
+ * by the caller, e.g. on its stack, it is not allocated from the memory pool.
+ */
+struct timer
+{
+   struct timer *next;
+   uint16_t delta;            // ticks relative to previous timer
+   uint8_t state;             // TIMER_IDLE, TIMER_PENDING
+   int8_t owner;              // pid of process which started the timer
+   uint16_t period;           // ticks of periodic timer, 0 = one-shot
+   void (*func)(void *);      // callback function
+   void *arg;                 // argument of callback function
+   uint8_t sem;               // semaphore which is posted if func is NULL
+};
+
 long int get_uptime(void);
 void tsleep(unsigned long);
 
+void timer_init(struct timer *, void (*)(void *), void *);
+void timer_init_sem(struct timer *, uint8_t);
+void timer_start(struct timer *, uint16_t, uint16_t);
+void timer_stop(struct timer *);
+void timer_wait(struct timer *, uint16_t);
+void timer_wait_idle(struct timer *);
+
+#endif
+
 #endif
 
@@ -0,0 +1,276 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file upload.c
+ * Upload code into the reserved flash region UPLOAD_START - UPLOAD_END. After
+ * the command `upload` the host sends an Intel HEX file line by line. The
+ * code has to be linked to an address within the region. The device answers
+ * every line with "." as soon as it was received, thus the host may send the
+ * next line while the previous page is programmed. Finally the device outputs
+ * the CRC16 of the uploaded range and the entry address which can be passed
+ * to `new`. An empty line aborts the upload. While a page is programmed the
+ * interrupts are disabled and boot_page_write() receives the bytes of USART0
+ * only, thus `upload` works only on the ttys of USART0.
+ *
+ * @author Bernhard R. Fischer, 4096R/8E24F29D bf@abenteuerland.at
+ */
+
+#include <avr/io.h>
+
+#include "avrshell.h"
+#include "parser.h"
+#include "progmem.h"
+#include "serial_io.h"
+#include "process.h"
+#include "memops.h"
+#include "crc.h"
+#include "pool.h"
+#include "upload.h"
+
+
+// USART and channel of each tty
+static const uint8_t tty_cfg_[] PROGMEM = {TTY_CONFIG};
+
+// Intel HEX record types
+#define IHEX_DATA 0
+#define IHEX_EOF 1
+#define IHEX_SEG 2
+#define IHEX_START_SEG 3
+#define IHEX_LIN 4
+#define IHEX_START_LIN 5
+
+#define PAGE_MASK (SPM_PAGESIZE - 1)
+#define NO_PAGE 0xffff
+
+static const char s_crc_[] PROGMEM = "crc = 0x";
+static const char s_entry_[] PROGMEM = ", entry = 0x";
+static const char s_eof_[] PROGMEM = ":00000001FF";
+
+struct upload
+{
+   uint16_t page;
+   uint16_t lo, hi;
+   uint16_t entry;
+   int8_t err;
+   // buffers allocated from the memory pool
+   char *pbuf;
+   char *spill;
+   char *lbuf;
+};
+
+
+/*! Write current page buffer to flash. */
+static void upload_flush(struct upload *up)
+{
+   uint8_t n;
+
+   if (up->page == NO_PAGE)
+      return;
+
+   n = boot_page_write(up->page, up->pbuf, up->spill, UPLOAD_SPILL_SIZE);
+   sys_rx_inject(up->spill, n);
+
+   if (mem_cmp((void*) up->page, MEM_PRG, up->pbuf, MEM_RAM, SPM_PAGESIZE) != SPM_PAGESIZE)
+      up->err = E_VERIFY;
+
+   up->page = NO_PAGE;
+}
+
+
+/*! Store byte to page buffer. The buffer is flushed if the byte belongs to a
+ * different page. A new page is initialized with the current flash contents.
+ */
+static void upload_byte(struct upload *up, uint16_t addr, char b)
+{
+   unsigned i;
+
+   if (addr < UPLOAD_START || addr >= UPLOAD_END)
+   {
+      up->err = E_INVAL;
+      return;
+   }
+
+   if ((addr & ~PAGE_MASK) != up->page)
+   {
+      upload_flush(up);
+      up->page = addr & ~PAGE_MASK;
+      for (i = 0; i < SPM_PAGESIZE; i++)
+         up->pbuf[i] = pgm_byte((void*) (up->page + i));
+   }
+
+   up->pbuf[addr & PAGE_MASK] = b;
+
+   if (addr < up->lo)
+      up->lo = addr;
+   if (addr > up->hi)
+      up->hi = addr;
+}
+
+
+static int hex_byte(const char *s)
+{
+   int8_t h, l;
+
+   if ((h = asc_to_nibble(s[0])) < 0 || (l = asc_to_nibble(s[1])) < 0)
+      return -1;
+   return h << 4 | l;
+}
+
+
+/*! Process one Intel HEX record.
+ * @return Returns the record type or -1 on error.
+ */
+static int8_t upload_record(struct upload *up, const char *s)
+{
+   // a record has at most (line length - ':') / 2 bytes
+   uint8_t buf[UPLOAD_LINE_MAX / 2], sum;
+   int b, i, len;
+
+   if (*s++ != ':')
+      return -1;
+
+   for (i = 0, len = 5, sum = 0; i < len; i++, s += 2)
+   {
+      if ((b = hex_byte(s)) < 0)
+         return -1;
+      buf[i] = b;
+      sum += b;
+      // length + address + type + data + checksum
+      if (!i && (len = b + 5) > (int) sizeof(buf))
+         return -1;
+   }
+
+   if (sum)
+      return -1;
+
+   switch (buf[3])
+   {
+      case IHEX_DATA:
+         for (i = 0; i < buf[0]; i++)
+            upload_byte(up, (buf[1] << 8 | buf[2]) + i, buf[4 + i]);
+         break;
+
+      case IHEX_SEG:
+      case IHEX_LIN:
+         // flash above 64k is not supported
+         if (buf[4] || buf[5])
+            return -1;
+         break;
+
+      case IHEX_START_SEG:
+         up->entry = (buf[4] << 8 | buf[5]) * 16 + (buf[6] << 8 | buf[7]);
+         break;
+
+      case IHEX_START_LIN:
+         up->entry = buf[6] << 8 | buf[7];
+         break;
+   }
+
+   return buf[3];
+}
+
+
+/*! Receive and program Intel HEX records until the EOF record. */
+static void upload_recv(struct upload *up)
+{
+   uint8_t n;
+   int8_t type;
+
+   for (;;)
+   {
+      n = sys_read(up->lbuf, UPLOAD_LINE_MAX - 1);
+      up->lbuf[n] = '\0';
+      sys_send('.');
+
+      if (is_eos(*up->lbuf))
+      {
+         up->err = E_INVAL;
+         break;
+      }
+
+      // after an error all records are ignored until the end
+      if (up->err)
+      {
+         if (!pstrncmp(up->lbuf, s_eof_, sizeof(s_eof_) - 1))
+            break;
+         continue;
+      }
+
+      if ((type = upload_record(up, up->lbuf)) == -1)
+         up->err = E_INVAL;
+      else if (type == IHEX_EOF)
+         break;
+   }
+
+   upload_flush(up);
+   println();
+}
+
+
+/*! upload */
+void cmd_upload(int8_t argc, int *argv, char *cmd)
+{
+   struct upload up;
+   uint8_t mode;
+
+   // bytes of the other USARTs would be lost while a page is programmed
+   if (pgm_byte(&tty_cfg_[2 * get_tty()]))
+   {
+      output_error(E_INVAL);
+      return;
+   }
+
+   up.page = NO_PAGE;
+   up.lo = 0xffff;
+   up.hi = 0;
+   up.entry = 0xffff;
+   up.err = E_OK;
+
+   up.pbuf = pool_alloc(SPM_PAGESIZE);
+   up.spill = pool_alloc(UPLOAD_SPILL_SIZE);
+   up.lbuf = pool_alloc(UPLOAD_LINE_MAX);
+
+   if (up.pbuf == NULL || up.spill == NULL || up.lbuf == NULL)
+      up.err = E_NOMEM;
+   else
+   {
+      // the records are not echoed
+      mode = sys_tty_mode(-1);
+      sys_tty_mode(mode & ~TTY_ECHO);
+      upload_recv(&up);
+      sys_tty_mode(mode);
+   }
+
+   pool_free(up.lbuf);
+   pool_free(up.spill);
+   pool_free(up.pbuf);
+
+   if (up.err || up.lo > up.hi)
+   {
+      output_error(up.err ? up.err : E_NOPARM);
+      return;
+   }
+
+   if (up.entry == 0xffff)
+      up.entry = up.lo;
+
+   sys_pwrite(s_crc_, sizeof(s_crc_) - 1);
+   write_ptr((void*) crc16((void*) up.lo, MEM_PRG, up.hi - up.lo + 1, CRC16_INIT));
+   sys_pwrite(s_entry_, sizeof(s_entry_) - 1);
+   write_ptr((void*) up.entry);
+   println();
+}
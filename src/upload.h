@@ -0,0 +1,50 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UPLOAD_H
+#define UPLOAD_H
+
+// start of boot section (byte address), it depends on the BOOTSZ fuses, it is
+// passed by the Makefile
+#ifndef BOOTSTART
+#define BOOTSTART 0x7000
+#endif
+// flash region reserved for uploaded code, it is located within the lower 64k,
+// it is passed by the Makefile which also checks that the kernel ends below it
+#ifndef UPLOAD_START
+#define UPLOAD_START 0x6000
+#endif
+#if BOOTSTART > 0x8000
+#define UPLOAD_END 0x8000
+#else
+#define UPLOAD_END BOOTSTART
+#endif
+// size of buffer for bytes received during page programming
+#define UPLOAD_SPILL_SIZE 16
+// size of line buffer for Intel HEX records
+#define UPLOAD_LINE_MAX 48
+
+#ifndef __ASSEMBLER__
+
+#include <stdint.h>
+
+uint8_t boot_page_write(uint16_t page, const char *data, char *spill, uint8_t size);
+
+#endif
+
+#endif
+
@@ -0,0 +1,157 @@
+/* Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+ *
+ * This file is part of AVRshell.
+ *
+ * Smrender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Smrender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with smrender. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file watch.c
+ * This file contains the watch command. Every watch is a background process
+ * which samples a memory range (RAM or IO registers) at a fixed interval and
+ * outputs a line only if the contents changed. The line has the format
+ * "W<pid> <uptime> <addr>: <bytes>". Optionally the watch stops if the first
+ * byte matches a trigger condition ((byte & mask) == value).
+ *
+ * @author Bernhard R. Fischer, 4096R/8E24F29D bf@abenteuerland.at
+ */
+
+#include "avrshell.h"
+#include "parser.h"
+#include "process.h"
+#include "pool.h"
+#include "serial_io.h"
+#include "timer.h"
+
+// maximum number of bytes per watch
+#define WATCH_MAX_LEN 8
+// default sample interval in ticks
+#define WATCH_INTERVAL 1
+
+struct watch
+{
+   const char *addr;
+   uint8_t len;
+   uint8_t trig;
+   uint8_t mask;
+   uint8_t val;
+   int interval;
+   char last[WATCH_MAX_LEN];
+};
+
+
+static void watch_print(pid_t pid, const struct watch *w, const char *buf)
+{
+   char s[12];
+   uint8_t i;
+
+   sys_send('W');
+   lint_to_str(pid, s, sizeof(s));
+   sys_write(s, strlen(s));
+   sys_send(' ');
+   lint_to_str(get_uptime(), s, sizeof(s));
+   sys_write(s, strlen(s));
+   sys_send(' ');
+   write_ptr(w->addr);
+   sys_send(':');
+   for (i = 0; i < w->len; i++)
+   {
+      sys_send(' ');
+      write_hexbyte(buf[i]);
+   }
+   println();
+}
+
+
+/*! Main function of the watch processes. */
+static void watch_proc(void)
+{
+   struct watch *w;
+   char buf[WATCH_MAX_LEN];
+   uint8_t i, changed;
+   pid_t pid;
+
+   // the watch parameters are attached to the process
+   pid = get_pid();
+   w = get_proc_list()[pid].data;
+
+   for (changed = 1;; changed = 0)
+   {
+      for (i = 0; i < w->len; i++)
+      {
+         buf[i] = w->addr[i];
+         if (buf[i] != w->last[i])
+            changed = 1;
+         w->last[i] = buf[i];
+      }
+
+      if (changed)
+         watch_print(pid, w, buf);
+
+      if (w->trig && (buf[0] & w->mask) == w->val)
+         break;
+
+      tsleep(w->interval);
+   }
+}
+
+
+/*! watch <addr> [<len> [<interval> [<mask> <value>]]] */
+void cmd_watch(int8_t argc, int *argv, char *cmd)
+{
+   struct watch *w;
+   char s[4];
+   pid_t pid;
+
+   if (argc > 1 && (argv[1] < 1 || argv[1] > WATCH_MAX_LEN))
+   {
+      output_error(E_INVAL);
+      return;
+   }
+
+   if (argc == 4)
+   {
+      output_error(E_NOPARM);
+      return;
+   }
+
+   if ((pid = new_proc(watch_proc)) < 0)
+   {
+      output_error(E_NOMEM);
+      return;
+   }
+
+   if ((w = pool_alloc(sizeof(*w))) == NULL)
+   {
+      kill_proc(pid);
+      output_error(E_NOMEM);
+      return;
+   }
+   get_proc_list()[pid].data = w;
+
+   w->addr = (const char*) argv[0];
+   w->len = argc > 1 ? argv[1] : 1;
+   w->interval = argc > 2 ? argv[2] : WATCH_INTERVAL;
+   w->trig = argc > 4;
+   if (w->trig)
+   {
+      w->mask = argv[3];
+      w->val = argv[4];
+   }
+
+   run_proc(pid);
+
+   lint_to_str(pid, s, sizeof(s));
+   sys_write(s, strlen(s));
+   println();
+}
+
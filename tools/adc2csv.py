@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+#
+# Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+#
+# This file is part of AVRshell.
+#
+# AVRshell is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, version 3 of the License.
+#
+# Convert the binary output of the AVRshell command `adc` into a CSV file with
+# the columns time (s) and value (0-255).
+#
+# The input is the raw data received from the serial line. It is searched for
+# the magic "ADC" followed by the channel, the sample rate in Hz and the number
+# of samples (16 bit little endian each). Then follow frames of a 'D', the
+# number of samples, the number of samples lost before the frame (16 bit) and
+# the samples. Lost samples leave a gap in the time column.
+#
+# @usage adc2csv.py <input> [<output.csv>]
+
+import struct
+import sys
+
+
+def decode(data):
+    pos = data.find(b"ADC")
+    if pos < 0:
+        raise ValueError("no ADC data found")
+    chan, rate, count = struct.unpack_from("<BHH", data, pos + 3)
+    pos += 8
+    samples = []
+    n = 0
+    while n < count and pos + 4 <= len(data) and data[pos] == ord('D'):
+        cnt, lost = struct.unpack_from("<BH", data, pos + 1)
+        pos += 4
+        if len(data) < pos + cnt:
+            raise ValueError("frame truncated")
+        n = len(samples) + lost
+        for val in data[pos:pos + cnt]:
+            samples.append((n, val))
+            n += 1
+        pos += cnt
+    if n < count:
+        sys.stderr.write("warning: %d of %d samples\n" % (n, count))
+    lost = n - len(samples)
+    if lost:
+        sys.stderr.write("warning: %d samples lost\n" % lost)
+    return chan, rate, samples
+
+
+def main(argv):
+    if len(argv) < 2:
+        sys.stderr.write("usage: %s <input> [<output.csv>]\n" % argv[0])
+        return 1
+    with open(argv[1], "rb") as f:
+        chan, rate, samples = decode(f.read())
+    out = open(argv[2], "w") if len(argv) > 2 else sys.stdout
+    out.write("time,adc%d\n" % chan)
+    for n, val in samples:
+        out.write("%f,%d\n" % (n / rate, val))
+    if out is not sys.stdout:
+        out.close()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+#
+# Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+#
+# This file is part of AVRshell.
+#
+# AVRshell is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, version 3 of the License.
+#
+# Convert the binary output of the AVRshell command `capture` into a VCD file
+# which can be viewed e.g. with gtkwave.
+#
+# The input is the raw data received from the serial line. It is searched for
+# the magic "CAP" followed by the sample rate in kHz, the number of samples and
+# the number of runs (16 bit little endian each) and the runs as pairs of
+# <value> <count>.
+#
+# @usage cap2vcd.py [-n <name>] <input> [<output.vcd>]
+
+import struct
+import sys
+
+
+def decode(data):
+    pos = data.find(b"CAP")
+    if pos < 0:
+        raise ValueError("no capture found")
+    rate, samples, runs = struct.unpack_from("<HHH", data, pos + 3)
+    pos += 9
+    if len(data) < pos + runs * 2:
+        raise ValueError("capture truncated")
+    values = []
+    for i in range(runs):
+        val, cnt = data[pos + i * 2], data[pos + i * 2 + 1]
+        values.extend([val] * cnt)
+    if len(values) != samples:
+        raise ValueError("sample count mismatch: %d != %d" % (len(values), samples))
+    return rate, values
+
+
+def write_vcd(out, rate, values, name):
+    period = 1000000 // rate      # ns
+    ids = [chr(ord('!') + i) for i in range(8)]
+    out.write("$timescale 1ns $end\n")
+    out.write("$scope module %s $end\n" % name)
+    for i in range(8):
+        out.write("$var wire 1 %s %s%d $end\n" % (ids[i], name, i))
+    out.write("$upscope $end\n$enddefinitions $end\n")
+    last = None
+    for n, val in enumerate(values):
+        if val == last:
+            continue
+        out.write("#%d\n" % (n * period))
+        for i in range(8):
+            if last is None or (val ^ last) & (1 << i):
+                out.write("%d%s\n" % ((val >> i) & 1, ids[i]))
+        last = val
+    out.write("#%d\n" % (len(values) * period))
+
+
+def main(argv):
+    name = "pin"
+    if len(argv) > 2 and argv[1] == "-n":
+        name = argv[2]
+        argv = argv[:1] + argv[3:]
+    if len(argv) < 2:
+        sys.stderr.write("usage: %s [-n <name>] <input> [<output.vcd>]\n" % argv[0])
+        return 1
+    with open(argv[1], "rb") as f:
+        rate, values = decode(f.read())
+    if len(argv) > 2:
+        with open(argv[2], "w") as out:
+            write_vcd(out, rate, values, name)
+    else:
+        write_vcd(sys.stdout, rate, values, name)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
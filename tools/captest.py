@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+#
+# Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+#
+# This file is part of AVRshell.
+#
+# AVRshell is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, version 3 of the License.
+#
+# Check the command `capture` together with cap2vcd.py. The tty is either the
+# serial line of a board or the pseudo terminal of the USART of simavr
+# (uart_pty). A constant pattern is written to GPIOR1 and captured by the
+# interrupt handler and by the polling loop, then TCNT0 which is counted by the
+# system timer is captured as a changing signal. Each capture is decoded with
+# cap2vcd.py and converted into a VCD file, the last one is written to
+# <output.vcd> if given. The exit code is 0 if all steps succeeded.
+#
+# @usage captest.py [-b <baud>] <tty> [<output.vcd>]
+
+import io
+import os
+import struct
+import sys
+import termios
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import cap2vcd
+
+BAUDS = {9600: termios.B9600, 19200: termios.B19200, 38400: termios.B38400,
+         57600: termios.B57600, 115200: termios.B115200}
+
+# IO addresses, identical on the ATmega328P and the ATmega2560
+GPIOR1 = 0x2a
+TCNT0 = 0x26
+PATTERN = 0xa5
+
+
+def shell(fd, line, timeout=1.0):
+    """Send a command line to the shell and return its output."""
+    os.write(fd, line.encode() + b"\r")
+    out = b""
+    end = time.time() + timeout
+    while time.time() < end:
+        try:
+            out += os.read(fd, 256)
+        except BlockingIOError:
+            time.sleep(0.05)
+    return out
+
+
+def capture(fd, line, timeout=20.0):
+    """Run `capture` and return the decoded rate and samples."""
+    os.write(fd, line.encode() + b"\r")
+    out = b""
+    end = time.time() + timeout
+    while time.time() < end:
+        try:
+            out += os.read(fd, 256)
+        except BlockingIOError:
+            time.sleep(0.05)
+            continue
+        if b"CAP" not in out and b"***" in out:
+            raise ValueError(out.decode(errors="replace").strip())
+        try:
+            return cap2vcd.decode(out)
+        except (ValueError, struct.error):
+            pass
+    return cap2vcd.decode(out)
+
+
+def check(name, rate, values, n, test):
+    """Convert the samples into a VCD and apply the test, return the VCD."""
+    vcd = io.StringIO()
+    cap2vcd.write_vcd(vcd, rate, values, "pin")
+    ok = len(values) == n and "$enddefinitions" in vcd.getvalue() and test(values)
+    print("%-12s %s (%d kHz, %d samples, %d values)" % (name, "ok" if ok else "FAILED", rate, len(values), len(set(values))))
+    return ok, vcd.getvalue()
+
+
+def main():
+    args = sys.argv[1:]
+    baud = 9600
+    if len(args) > 1 and args[0] == "-b":
+        baud = int(args[1])
+        args = args[2:]
+    if len(args) not in (1, 2) or baud not in BAUDS:
+        print("usage: %s [-b <baud>] <tty> [<output.vcd>]" % sys.argv[0], file=sys.stderr)
+        return 1
+
+    fd = os.open(args[0], os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+    attr = termios.tcgetattr(fd)
+    attr[0] = attr[1] = attr[3] = 0
+    attr[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+    attr[4] = attr[5] = BAUDS[baud]
+    termios.tcsetattr(fd, termios.TCSANOW, attr)
+
+    shell(fd, "")
+    shell(fd, "out 0x%02x 0x%02x" % (GPIOR1, PATTERN))
+
+    steps = [
+        ("isr", "capture 0x%02x 10 64" % GPIOR1, 64, lambda v: set(v) == {PATTERN}),
+        ("poll", "capture 0x%02x 100 64" % GPIOR1, 64, lambda v: set(v) == {PATTERN}),
+        ("TCNT0", "capture 0x%02x 1000 256" % TCNT0, 256, lambda v: len(set(v)) > 1),
+    ]
+    err, vcd = 0, ""
+    for name, line, n, test in steps:
+        try:
+            rate, values = capture(fd, line)
+        except (ValueError, struct.error) as e:
+            print("%-12s FAILED (%s)" % (name, e))
+            err = 1
+            continue
+        ok, vcd = check(name, rate, values, n, test)
+        err |= not ok
+        # skip the rest of the output
+        shell(fd, "", 0.5)
+    os.close(fd)
+
+    if len(args) > 1 and vcd:
+        with open(args[1], "w") as f:
+            f.write(vcd)
+    return err
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+#
+# Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+#
+# This file is part of AVRshell.
+#
+# AVRshell is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, version 3 of the License.
+#
+# Check the gdb stub of AVRshell with avr-gdb. The tty is either the serial
+# line of a board or the pseudo terminal of the USART of simavr (uart_pty).
+# A background process is started with `watch`, then `gdb <pid>` turns the
+# tty into the stub. avr-gdb attaches, lists the threads, reads RAM, flash,
+# and EEPROM, continues the process and stops it again with Ctrl-C (SIGINT),
+# and finally kills it. The exit code is 0 if all steps succeeded.
+#
+# Note: this script has not been run yet, see the section "Debugging with GDB"
+# of the README.
+#
+# @usage gdbtest.py [-b <baud>] [-g <avr-gdb>] <file.elf> <tty>
+
+import os
+import re
+import signal
+import subprocess
+import sys
+import termios
+import threading
+import time
+
+BAUDS = {9600: termios.B9600, 19200: termios.B19200, 38400: termios.B38400,
+         57600: termios.B57600, 115200: termios.B115200}
+
+# output of avr-gdb which is expected after each step
+CHECKS = [
+    ("attach", r"Remote debugging using"),
+    ("info threads", r"Thread \d+"),
+    ("RAM", r"0x800100"),
+    ("flash", r"0x0( <[^>]*>)?:"),
+    ("EEPROM", r"0x810000"),
+    ("Ctrl-C", r"SIGINT"),
+]
+
+
+def shell(fd, line, timeout=2.0):
+    """Send a command line to the shell and return its output."""
+    os.write(fd, line.encode() + b"\r")
+    out = b""
+    end = time.time() + timeout
+    while time.time() < end:
+        try:
+            out += os.read(fd, 256)
+        except BlockingIOError:
+            time.sleep(0.05)
+    return out.decode(errors="replace")
+
+
+def start_stub(tty, baud):
+    """Start a watch process and the stub, return the pid of the process."""
+    fd = os.open(tty, os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+    attr = termios.tcgetattr(fd)
+    attr[0] = attr[1] = attr[3] = 0
+    attr[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+    attr[4] = attr[5] = BAUDS[baud]
+    termios.tcsetattr(fd, termios.TCSANOW, attr)
+
+    shell(fd, "")
+    m = re.search(r"^(\d+)\s*$", shell(fd, "watch 0x100 1 61"), re.M)
+    if not m:
+        os.close(fd)
+        raise RuntimeError("watch did not return a pid")
+    pid = int(m.group(1))
+    shell(fd, "gdb %d" % pid, 0.5)
+    os.close(fd)
+    return pid
+
+
+def main():
+    args = sys.argv[1:]
+    baud, gdb = 9600, "avr-gdb"
+    while len(args) > 2:
+        if args[0] == "-b":
+            baud = int(args[1])
+        elif args[0] == "-g":
+            gdb = args[1]
+        else:
+            break
+        args = args[2:]
+    if len(args) != 2 or baud not in BAUDS:
+        print("usage: %s [-b <baud>] [-g <avr-gdb>] <file.elf> <tty>" % sys.argv[0], file=sys.stderr)
+        return 1
+    elf, tty = args
+
+    pid = start_stub(tty, baud)
+    cmds = [
+        "set confirm off",
+        "set serial baud %d" % baud,
+        "target remote %s" % tty,
+        "info threads",
+        "thread %d" % pid,
+        "info registers pc",
+        "x/8xb 0x800100",
+        "x/8xb 0",
+        "x/8xb 0x810000",
+        "continue",
+        "info registers pc",
+        "kill",
+    ]
+    argv = [gdb, "-nx", "-batch"]
+    for c in cmds:
+        argv += ["-ex", c]
+    proc = subprocess.Popen(argv + [elf], stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+
+    # Ctrl-C after the process ran for a while
+    threading.Timer(5.0, proc.send_signal, [signal.SIGINT]).start()
+    out = proc.communicate(timeout=60)[0].decode(errors="replace")
+    print(out)
+
+    err = 0
+    for name, pattern in CHECKS:
+        ok = re.search(pattern, out) is not None
+        print("%-12s %s" % (name, "ok" if ok else "FAILED"))
+        err |= not ok
+    return err
+
+
+if __name__ == "__main__":
+    sys.exit(main())
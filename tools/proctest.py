@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+#
+# Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+#
+# This file is part of AVRshell.
+#
+# AVRshell is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, version 3 of the License.
+#
+# Check that the kernel runs <n> background processes at the same time. The
+# tty is either the serial line of a board or the pseudo terminal of the USART
+# of simavr (uart_pty). <n> processes are started with `watch`, then `ps` has
+# to list all of them. Finally they are killed and `ps` must not list them
+# anymore. `make simprocs` calls it with MAX_PROCS - 2 processes. The exit
+# code is 0 if all steps succeeded.
+#
+# @usage proctest.py [-b <baud>] <tty> <n>
+
+import os
+import re
+import sys
+import termios
+import time
+
+BAUDS = {9600: termios.B9600, 19200: termios.B19200, 38400: termios.B38400,
+         57600: termios.B57600, 115200: termios.B115200}
+
+
+def shell(fd, line, timeout=1.0):
+    """Send a command line to the shell and return its output."""
+    os.write(fd, line.encode() + b"\r")
+    out = b""
+    end = time.time() + timeout
+    while time.time() < end:
+        try:
+            out += os.read(fd, 256)
+        except BlockingIOError:
+            time.sleep(0.05)
+    return out.decode(errors="replace")
+
+
+def ps(fd):
+    """Return the pids listed by `ps`."""
+    return {int(m.group(1)) for m in re.finditer(r"^(\d+) 0x[0-9a-fA-F]+ \d+ \d+\s*$", shell(fd, "ps"), re.M)}
+
+
+def main():
+    args = sys.argv[1:]
+    baud = 9600
+    if len(args) > 2 and args[0] == "-b":
+        baud = int(args[1])
+        args = args[2:]
+    if len(args) != 2 or baud not in BAUDS:
+        print("usage: %s [-b <baud>] <tty> <n>" % sys.argv[0], file=sys.stderr)
+        return 1
+    n = int(args[1])
+
+    fd = os.open(args[0], os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+    attr = termios.tcgetattr(fd)
+    attr[0] = attr[1] = attr[3] = 0
+    attr[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+    attr[4] = attr[5] = BAUDS[baud]
+    termios.tcsetattr(fd, termios.TCSANOW, attr)
+
+    shell(fd, "")
+    pids = []
+    for i in range(n):
+        out = shell(fd, "watch 0x100 1 61")
+        m = re.search(r"^(\d+)\s*$", out, re.M)
+        if not m:
+            print("watch %d FAILED: %s" % (i + 1, out.strip()))
+            break
+        pids.append(int(m.group(1)))
+
+    err = 0
+    running = ps(fd)
+    ok = len(pids) == n and set(pids) <= running
+    print("%-12s %s (%d of %d started, %d listed)" % ("start", "ok" if ok else "FAILED", len(pids), n, len(set(pids) & running)))
+    err |= not ok
+
+    for pid in pids:
+        shell(fd, "kill %d" % pid, 0.2)
+    running = ps(fd)
+    ok = not set(pids) & running
+    print("%-12s %s (%d still listed)" % ("kill", "ok" if ok else "FAILED", len(set(pids) & running)))
+    err |= not ok
+
+    os.close(fd)
+    return err
+
+
+if __name__ == "__main__":
+    sys.exit(main())
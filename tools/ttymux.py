@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+#
+# Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+#
+# This file is part of AVRshell.
+#
+# AVRshell is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, version 3 of the License.
+#
+# Demultiplex the virtual ttys of AVRshell into pseudo terminals.
+#
+# The virtual ttys share a serial line. A channel is selected by the byte DLE
+# (0x10) followed by '0' + channel. DLE, XON, and XOFF within the data are
+# preceded by DLE. For each channel a pseudo terminal is created which can be
+# opened with any terminal program, e.g. `screen /dev/pts/5`. Unescaped XOFF
+# and XON sent by the device pause respectively resume the output to the
+# device.
+#
+# @usage ttymux.py [-n <channels>] <serial_device>
+
+import os
+import select
+import sys
+import termios
+import tty
+
+DLE = 0x10
+XON = 0x11
+XOFF = 0x13
+
+
+def open_serial(dev):
+    fd = os.open(dev, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    attr = termios.tcgetattr(fd)
+    attr[4] = attr[5] = termios.B9600
+    termios.tcsetattr(fd, termios.TCSANOW, attr)
+    return fd
+
+
+def open_pty():
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    return master, slave
+
+
+def main(argv):
+    nchan = 2
+    if len(argv) > 2 and argv[1] == "-n":
+        nchan = int(argv[2])
+        argv = argv[:1] + argv[3:]
+    if len(argv) < 2:
+        sys.stderr.write("usage: %s [-n <channels>] <serial_device>\n" % argv[0])
+        return 1
+
+    ser = open_serial(argv[1])
+    ptys = [open_pty() for i in range(nchan)]
+    for i, (master, slave) in enumerate(ptys):
+        print("channel %d: %s" % (i, os.ttyname(slave)))
+    sys.stdout.flush()
+
+    # select channel 0, this also activates the multiplexing on the device
+    os.write(ser, bytes([DLE, ord('0')]))
+    txchan = 0
+    rxchan = 0
+    rxdle = False
+    paused = False
+
+    fds = [ser] + [m for m, s in ptys]
+    while True:
+        for fd in select.select(fds[:1] if paused else fds, [], [])[0]:
+            # small chunks from the terminals, thus XOFF takes effect soon
+            data = os.read(fd, 256 if fd == ser else 16)
+            if fd == ser:
+                out = bytearray()
+                for c in data:
+                    if rxdle:
+                        rxdle = False
+                        if c not in (DLE, XON, XOFF):
+                            if out:
+                                os.write(ptys[rxchan][0], out)
+                                out = bytearray()
+                            if 0 <= c - ord('0') < nchan:
+                                rxchan = c - ord('0')
+                            continue
+                    elif c == DLE:
+                        rxdle = True
+                        continue
+                    elif c in (XON, XOFF):
+                        paused = c == XOFF
+                        continue
+                    out.append(c)
+                if out:
+                    os.write(ptys[rxchan][0], out)
+            else:
+                chan = fds.index(fd) - 1
+                out = bytearray()
+                if chan != txchan:
+                    out += bytes([DLE, ord('0') + chan])
+                    txchan = chan
+                for c in data:
+                    if c in (DLE, XON, XOFF):
+                        out.append(DLE)
+                    out.append(c)
+                os.write(ser, out)
+
+
+if __name__ == "__main__":
+    try:
+        sys.exit(main(sys.argv))
+    except KeyboardInterrupt:
+        sys.exit(0)
@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+#
+# Copyright 2019-2020 Bernhard R. Fischer, 4096R/8E24F29D <bf@abenteuerland.at>
+#
+# This file is part of AVRshell.
+#
+# AVRshell is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, version 3 of the License.
+#
+# Check the command `upload` end to end. The tty is either the serial line of
+# a board or the pseudo terminal of the USART of simavr (uart_pty). The Intel
+# HEX file is sent line by line, every line is sent after the device answered
+# the previous one with ".". The CRC16 of the written range which is reported
+# by the device is compared to the CRC16 calculated from the HEX file. Bytes
+# between the records are assumed to be erased (0xff) as in a fresh simulator.
+# The exit code is 0 if the CRC and the entry address match.
+#
+# @usage uploadtest.py [-b <baud>] <file.hex> <tty>
+
+import os
+import re
+import sys
+import termios
+import time
+
+BAUDS = {9600: termios.B9600, 19200: termios.B19200, 38400: termios.B38400,
+         57600: termios.B57600, 115200: termios.B115200}
+
+
+def crc16(data, crc=0xffff):
+    """CRC-16/CCITT as in src/crc.S (polynomial 0x1021, initial value 0xffff)."""
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = (crc << 1 ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xffff
+    return crc
+
+
+def read_hex(name):
+    """Read an Intel HEX file, return the lines, the memory image, and the entry address."""
+    lines, mem, entry, base = [], {}, None, 0
+    with open(name) as f:
+        for line in f:
+            line = line.strip()
+            if not line.startswith(":"):
+                continue
+            lines.append(line)
+            rec = bytes.fromhex(line[1:])
+            n, addr, typ = rec[0], rec[1] << 8 | rec[2], rec[3]
+            if typ == 0:
+                for i in range(n):
+                    mem[base + addr + i] = rec[4 + i]
+            elif typ == 2:
+                base = (rec[4] << 8 | rec[5]) * 16
+            elif typ == 3:
+                entry = (rec[4] << 8 | rec[5]) * 16 + (rec[6] << 8 | rec[7])
+            elif typ == 4:
+                base = (rec[4] << 8 | rec[5]) << 16
+            elif typ == 5:
+                entry = rec[6] << 8 | rec[7]
+    if not mem:
+        raise RuntimeError("%s contains no data" % name)
+    lo, hi = min(mem), max(mem)
+    if entry is None:
+        entry = lo
+    return lines, bytes(mem.get(a, 0xff) for a in range(lo, hi + 1)), entry
+
+
+def read_until(fd, pattern, timeout, out=b""):
+    """Read from the tty until the pattern matches the output, return it."""
+    end = time.time() + timeout
+    while time.time() < end and not re.search(pattern, out):
+        try:
+            out += os.read(fd, 256)
+        except BlockingIOError:
+            time.sleep(0.01)
+    return out
+
+
+def main():
+    args = sys.argv[1:]
+    baud = 9600
+    if len(args) > 2 and args[0] == "-b":
+        baud = int(args[1])
+        args = args[2:]
+    if len(args) != 2 or baud not in BAUDS:
+        print("usage: %s [-b <baud>] <file.hex> <tty>" % sys.argv[0], file=sys.stderr)
+        return 1
+    lines, image, entry = read_hex(args[0])
+    crc = crc16(image)
+
+    fd = os.open(args[1], os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+    attr = termios.tcgetattr(fd)
+    attr[0] = attr[1] = attr[3] = 0
+    attr[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+    attr[4] = attr[5] = BAUDS[baud]
+    termios.tcsetattr(fd, termios.TCSANOW, attr)
+
+    # empty line to get a fresh prompt, the output is dropped
+    os.write(fd, b"\r")
+    read_until(fd, rb"(?!)", 1.0)
+    os.write(fd, b"upload\r")
+    read_until(fd, rb"upload", 1.0)
+    # the answer to the last line is followed by the result
+    out = b""
+    for line in lines:
+        os.write(fd, line.encode() + b"\r")
+        out = read_until(fd, rb"\.", 5.0, out)
+        if b"." not in out:
+            print("no answer to %s" % line)
+            os.close(fd)
+            return 1
+        out = out[out.index(b".") + 1:]
+    out = read_until(fd, rb"entry = 0x[0-9a-fA-F]{4}|\*\*\*.*\n", 10.0, out)
+    os.close(fd)
+    out = out.decode(errors="replace")
+    print(out.strip())
+
+    m = re.search(r"crc = 0x([0-9a-fA-F]+), entry = 0x([0-9a-fA-F]+)", out)
+    if not m:
+        print("upload FAILED")
+        return 1
+    err = 0
+    for name, dev, host in (("crc", int(m.group(1), 16), crc), ("entry", int(m.group(2), 16), entry)):
+        ok = dev == host
+        print("%-12s %s (device 0x%04x, file 0x%04x)" % (name, "ok" if ok else "FAILED", dev, host))
+        err |= not ok
+    return err
+
+
+if __name__ == "__main__":
+    sys.exit(main())